@@ -0,0 +1,88 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+namespace nodal
+{
+
+// Monotonic chunked allocator. Memory handed out by allocate() is never
+// freed individually: release() drops everything at once, keeping the
+// largest chunk around for reuse.
+class arena {
+public:
+    static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+    // While a scope is alive, node_data objects created on the current
+    // thread are placed in its arena.
+    class scope {
+    public:
+        explicit scope(arena* arena);
+        ~scope();
+
+        scope(scope const&) = delete;
+        scope& operator=(scope const&) = delete;
+
+    private:
+        arena* previous;
+    };
+
+    explicit arena(std::size_t chunk_size = default_chunk_size);
+    ~arena();
+
+    arena(arena const&) = delete;
+    arena& operator=(arena const&) = delete;
+
+    void* allocate(std::size_t size,
+                   std::size_t alignment = alignof(std::max_align_t));
+
+    void release();
+
+    bool owns(void const* ptr) const;
+
+    std::size_t chunk_size() const {
+        return chunk_size_;
+    }
+
+    static arena* current();
+
+private:
+    struct chunk {
+        chunk* next;
+        std::size_t size;
+    };
+
+    void grow(std::size_t min_size);
+
+    std::size_t chunk_size_;
+
+    chunk* chunks = nullptr;
+    char* ptr = nullptr;
+    char* end = nullptr;
+};
+
+} /* namespace nodal */
@@ -26,17 +26,146 @@
 
 #include "any.hpp"
 
-#include <map>
+#include "detail/arena_allocator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace nodal
 {
 
-using attribute_key = std::string;
+// Interned attribute name. Atoms with equal names share one integer id,
+// assigned on first use and kept for the lifetime of the program, so
+// comparing atoms never touches the name. Interning takes a global lock;
+// code on hot paths should construct its atoms once and reuse them.
+class atom {
+public:
+    atom() = default;
+    atom(char const* name);
+    atom(std::string const& name);
+
+    std::uint32_t id() const {
+        return id_;
+    }
+
+    std::string const& name() const;
+
+    bool empty() const {
+        return id_ == 0;
+    }
+
+    bool operator==(atom other) const {
+        return id_ == other.id_;
+    }
+
+    bool operator!=(atom other) const {
+        return id_ != other.id_;
+    }
+
+    bool operator<(atom other) const {
+        return id_ < other.id_;
+    }
+
+private:
+    std::uint32_t id_ = 0;
+};
+
+using attribute_key = atom;
 using attribute_value = any;
+using attribute = std::pair<attribute_key, attribute_value>;
+
+// Attributes of a node as a flat vector sorted by key id. Nodes carry a
+// handful of attributes, for which a binary search over contiguous
+// entries beats a node-based tree on both lookup time and memory.
+class attribute_map {
+    using storage =
+        std::vector<attribute, detail::arena_allocator<attribute>>;
+
+public:
+    using allocator_type = storage::allocator_type;
+    using iterator = storage::iterator;
+    using const_iterator = storage::const_iterator;
+
+    attribute_map() = default;
+
+    explicit attribute_map(allocator_type const& alloc) : entries(alloc) {}
+
+    attribute_map(attribute_map const& other, allocator_type const& alloc)
+        : entries(other.entries, alloc)
+        {}
+
+    iterator begin() {
+        return entries.begin();
+    }
+
+    iterator end() {
+        return entries.end();
+    }
+
+    const_iterator begin() const {
+        return entries.begin();
+    }
+
+    const_iterator end() const {
+        return entries.end();
+    }
+
+    std::size_t size() const {
+        return entries.size();
+    }
+
+    bool empty() const {
+        return entries.empty();
+    }
+
+    iterator find(attribute_key key) {
+        auto it = lower_bound(key);
+        return (it != entries.end() && it->first == key) ? it : entries.end();
+    }
+
+    const_iterator find(attribute_key key) const {
+        return const_cast<attribute_map*>(this)->find(key);
+    }
+
+    std::size_t count(attribute_key key) const {
+        return find(key) != end();
+    }
+
+    attribute_value& operator[](attribute_key key) {
+        auto it = lower_bound(key);
+
+        if (it == entries.end() || it->first != key)
+            it = entries.emplace(it, key, attribute_value());
+
+        return it->second;
+    }
+
+    attribute_value& at(attribute_key key);
+    attribute_value const& at(attribute_key key) const;
+
+    std::size_t erase(attribute_key key) {
+        auto it = find(key);
+
+        if (it == entries.end())
+            return 0;
+
+        entries.erase(it);
+        return 1;
+    }
 
-using attribute_map = std::map<attribute_key, attribute_value>;
+private:
+    iterator lower_bound(attribute_key key) {
+        return std::lower_bound(entries.begin(), entries.end(), key,
+                                [](attribute const& a, attribute_key k) {
+                                    return a.first < k;
+                                });
+    }
 
-using attribute = attribute_map::value_type;
+    storage entries;
+};
 
 } /* namespace nodal */
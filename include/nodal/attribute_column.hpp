@@ -0,0 +1,194 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "graph_link.hpp"
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    // Type-erased interface through which a graph keeps its columns in
+    // step with its node list.
+    class column_base {
+    public:
+        virtual ~column_base() = default;
+
+        virtual column_base* clone() const = 0;
+
+        virtual void resize(std::size_t size) = 0;
+        virtual void clear() = 0;
+
+        // Mirror node_list::erase_and_dispose.
+        virtual void erase(std::size_t index) = 0;
+        virtual void erase(boost::dynamic_bitset<> const& mask) = 0;
+
+        // Move the entry at order[i] to i, for every i.
+        virtual void permute(std::vector<std::uint32_t> const& order) = 0;
+    };
+
+} /* namespace detail */
+
+// Dense array holding one value of an attribute for each node or each link
+// of a graph, indexed by graph_node::index() or graph_link::index(). Values
+// follow their elements as the graph adds and removes them; new elements
+// start out with the column's initial value.
+template <typename T>
+class attribute_column : public detail::column_base {
+    static_assert(!std::is_same<T, bool>::value,
+                  "std::vector<bool> elements are not addressable: "
+                  "use a char column instead");
+
+public:
+    using value_type = T;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    explicit attribute_column(std::size_t size = 0, T const& initial = T())
+        : values(size, initial), initial(initial)
+        {}
+
+    T& operator[](std::size_t index) {
+        return values[index];
+    }
+
+    T const& operator[](std::size_t index) const {
+        return values[index];
+    }
+
+    T& operator[](graph_node const* node) {
+        return values[node->index()];
+    }
+
+    T const& operator[](graph_node const* node) const {
+        return values[node->index()];
+    }
+
+    T& operator[](graph_link const& link) {
+        return values[link.index()];
+    }
+
+    T const& operator[](graph_link const& link) const {
+        return values[link.index()];
+    }
+
+    T* data() {
+        return values.data();
+    }
+
+    T const* data() const {
+        return values.data();
+    }
+
+    std::size_t size() const {
+        return values.size();
+    }
+
+    iterator begin() {
+        return values.begin();
+    }
+
+    iterator end() {
+        return values.end();
+    }
+
+    const_iterator begin() const {
+        return values.begin();
+    }
+
+    const_iterator end() const {
+        return values.end();
+    }
+
+    // Reset every value, keeping the size.
+    void fill() {
+        fill(initial);
+    }
+
+    void fill(T const& value) {
+        std::fill(values.begin(), values.end(), value);
+    }
+
+private:
+    column_base* clone() const override {
+        return new attribute_column(*this);
+    }
+
+    void resize(std::size_t size) override {
+        values.resize(size, initial);
+    }
+
+    void clear() override {
+        values.clear();
+    }
+
+    void erase(std::size_t index) override {
+        if (index + 1 < values.size())
+            values[index] = std::move(values.back());
+
+        values.pop_back();
+    }
+
+    void erase(boost::dynamic_bitset<> const& mask) override {
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (i < mask.size() && mask[i])
+                continue;
+
+            if (kept != i)
+                values[kept] = std::move(values[i]);
+
+            ++kept;
+        }
+
+        values.resize(kept, initial);
+    }
+
+    void permute(std::vector<std::uint32_t> const& order) override {
+        std::vector<T> permuted;
+        permuted.reserve(values.size());
+
+        for (auto i : order)
+            permuted.push_back(std::move(values[i]));
+
+        values.swap(permuted);
+    }
+
+    std::vector<T> values;
+    T initial;
+};
+
+} /* namespace nodal */
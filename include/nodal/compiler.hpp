@@ -44,6 +44,7 @@ public:
 
 private:
     friend class compiler;
+    friend class subgraph_compilation_pass;
 
     void set(std::type_index const& pass, any&& data);
     any get(std::type_index const& pass) const;
@@ -0,0 +1,97 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "../arena.hpp"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    // Allocator drawing from an arena, or from the global heap when no arena
+    // is given. Deallocation is a no-op for arena memory. Containers moved
+    // or swapped carry their allocator along; copies fall back to the heap.
+    template <typename T>
+    class arena_allocator {
+    public:
+        using value_type = T;
+
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        arena_allocator() = default;
+        arena_allocator(class arena* arena) : arena_(arena) {}
+
+        template <typename U>
+        arena_allocator(arena_allocator<U> const& other)
+            : arena_(other.arena())
+            {}
+
+        class arena* arena() const {
+            return arena_;
+        }
+
+        T* allocate(std::size_t n) {
+            if (arena_)
+                return static_cast<T*>(
+                    arena_->allocate(n * sizeof(T), alignof(T)));
+
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t) {
+            if (!arena_)
+                ::operator delete(ptr);
+        }
+
+        arena_allocator select_on_container_copy_construction() const {
+            return {};
+        }
+
+        template <typename U>
+        bool operator==(arena_allocator<U> const& other) const {
+            return arena_ == other.arena();
+        }
+
+        template <typename U>
+        bool operator!=(arena_allocator<U> const& other) const {
+            return arena_ != other.arena();
+        }
+
+    private:
+        class arena* arena_ = nullptr;
+    };
+
+} /* namespace detail */
+
+} /* namespace nodal */
@@ -0,0 +1,169 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <boost/graph/adjacency_iterator.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+#include <cstddef>
+#include <type_traits>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    // Whether Graph is a read-only graph in compressed sparse row form,
+    // such as frozen_graph or paged_graph. Such a graph identifies nodes
+    // and links by dense ids and provides nodes(), links(), link(id),
+    // input_links(), output_links(), the matching degrees and npos; it is
+    // then adapted to the BGL below and in csr_graph_properties.hpp.
+    template <typename Graph>
+    struct is_csr_graph : std::false_type {};
+
+    template <typename Graph, typename T>
+    using enable_if_csr_graph_t =
+        std::enable_if_t<is_csr_graph<Graph>::value, T>;
+
+    template <typename Graph>
+    struct csr_graph_traits {
+        using vertex_descriptor = typename Graph::node_id;
+        using edge_descriptor = typename Graph::link_id;
+
+        using directed_category = boost::directed_tag;
+        using edge_parallel_category = boost::allow_parallel_edge_tag;
+
+        struct traversal_category : boost::vertex_list_graph_tag,
+                                    boost::edge_list_graph_tag,
+                                    boost::bidirectional_graph_tag,
+                                    boost::adjacency_graph_tag {};
+
+        using vertex_iterator = typename Graph::node_iterator;
+        using edge_iterator = typename Graph::link_iterator;
+
+        using vertices_size_type = std::size_t;
+        using edges_size_type = std::size_t;
+
+        using in_edge_iterator = typename Graph::input_link_iterator;
+        using out_edge_iterator = typename Graph::output_link_iterator;
+        using degree_size_type = std::size_t;
+
+        using adjacency_iterator =
+            typename boost::adjacency_iterator_generator<
+                Graph, vertex_descriptor, out_edge_iterator>::type;
+
+        static constexpr vertex_descriptor null_vertex() {
+            return Graph::npos;
+        }
+    };
+
+} /* namespace detail */
+
+} /* namespace nodal */
+
+namespace boost
+{
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, typename Graph::node_range>
+vertices(Graph const& g) {
+    return g.nodes();
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, typename Graph::link_range>
+edges(Graph const& g) {
+    return g.links();
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, std::size_t>
+num_vertices(Graph const& g) {
+    return g.node_count();
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, std::size_t>
+num_edges(Graph const& g) {
+    return g.link_count();
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, typename Graph::node_id>
+source(typename Graph::link_id e, Graph const& g) {
+    return g.link(e).source_node;
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, typename Graph::node_id>
+target(typename Graph::link_id e, Graph const& g) {
+    return g.link(e).target_node;
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph,
+                                            typename Graph::input_link_range>
+in_edges(typename Graph::node_id v, Graph const& g) {
+    return g.input_links(v);
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph,
+                                            typename Graph::output_link_range>
+out_edges(typename Graph::node_id v, Graph const& g) {
+    return g.output_links(v);
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, std::size_t>
+in_degree(typename Graph::node_id v, Graph const& g) {
+    return g.input_degree(v);
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, std::size_t>
+out_degree(typename Graph::node_id v, Graph const& g) {
+    return g.output_degree(v);
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, std::size_t>
+degree(typename Graph::node_id v, Graph const& g) {
+    return g.degree(v);
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<
+    Graph, std::pair<typename graph_traits<Graph>::adjacency_iterator,
+                     typename graph_traits<Graph>::adjacency_iterator>>
+adjacent_vertices(typename Graph::node_id v, Graph const& g) {
+    using iterator = typename graph_traits<Graph>::adjacency_iterator;
+    auto range = out_edges(v, g);
+
+    return { iterator(range.first, &g), iterator(range.second, &g) };
+}
+
+} /* namespace boost */
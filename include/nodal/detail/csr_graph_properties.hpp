@@ -0,0 +1,75 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "csr_graph_access.hpp"
+
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+
+namespace boost
+{
+
+template <typename Graph>
+struct property_map<Graph, vertex_index_t,
+                    nodal::detail::enable_if_csr_graph_t<Graph, void>> {
+    using type = typed_identity_property_map<typename Graph::node_id>;
+    using const_type = type;
+};
+
+template <typename Graph>
+struct property_map<Graph, edge_index_t,
+                    nodal::detail::enable_if_csr_graph_t<Graph, void>> {
+    using type = typed_identity_property_map<typename Graph::link_id>;
+    using const_type = type;
+};
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<
+    Graph, typename property_map<Graph, vertex_index_t>::const_type>
+get(vertex_index_t, Graph const&) {
+    return {};
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<
+    Graph, typename property_map<Graph, edge_index_t>::const_type>
+get(edge_index_t, Graph const&) {
+    return {};
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, typename Graph::node_id>
+get(vertex_index_t, Graph const&, typename Graph::node_id v) {
+    return v;
+}
+
+template <typename Graph>
+inline nodal::detail::enable_if_csr_graph_t<Graph, typename Graph::link_id>
+get(edge_index_t, Graph const&, typename Graph::link_id e) {
+    return e;
+}
+
+} /* namespace boost */
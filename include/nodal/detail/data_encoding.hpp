@@ -0,0 +1,107 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "../node_data.hpp"
+#include "../typed_node.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    // How the data of a node is stored in graph images and patches: the
+    // bytes of raw-copyable data, or else the fields of a typed node as
+    // written by typed_node::serialize_data().
+    enum class data_encoding : std::uint8_t { none, raw, serialized };
+
+    // Encoding encode_data() uses for data of the given node; none if the
+    // data is null or can be stored neither way.
+    inline data_encoding encoding_of(class node const* node,
+                                     node_data const* data) {
+        if (!data)
+            return data_encoding::none;
+
+        if (data->raw_size())
+            return data_encoding::raw;
+
+        if (dynamic_cast<typed_node const*>(node))
+            return data_encoding::serialized;
+
+        return data_encoding::none;
+    }
+
+    // Append the stored form of data to out.
+    inline data_encoding encode_data(class node const* node,
+                                     node_data const* data,
+                                     std::vector<std::uint8_t>& out) {
+        auto encoding = encoding_of(node, data);
+
+        if (encoding == data_encoding::raw) {
+            auto bytes = static_cast<std::uint8_t const*>(data->raw_data());
+            out.insert(out.end(), bytes, bytes + data->raw_size());
+        } else if (encoding == data_encoding::serialized) {
+            static_cast<typed_node const*>(node)->serialize_data(data, out);
+        }
+
+        return encoding;
+    }
+
+    // Restore data from a block written by encode_data(). Throws
+    // std::invalid_argument if the block does not fit the data.
+    inline void decode_data(class node const* node, node_data* data,
+                            data_encoding encoding, std::uint8_t const* block,
+                            std::size_t size) {
+        if (encoding == data_encoding::none && size == 0)
+            return;
+
+        if (!data || encoding != encoding_of(node, data))
+            throw std::invalid_argument("Node data does not match block");
+
+        if (encoding == data_encoding::raw) {
+            if (data->raw_size() != size)
+                throw std::invalid_argument("Node data does not match block");
+
+            std::memcpy(data->raw_data(), block, size);
+        } else {
+            auto end = block + size;
+            static_cast<typed_node const*>(node)->deserialize_data(block, end,
+                                                                   data);
+
+            if (block != end)
+                throw std::invalid_argument("Node data does not match block");
+        }
+    }
+
+} /* namespace detail */
+
+} /* namespace nodal */
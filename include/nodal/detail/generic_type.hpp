@@ -27,8 +27,13 @@
 #include <boost/lexical_cast.hpp>
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 namespace nodal
 {
@@ -515,6 +520,203 @@ namespace detail
           generic_type_traits<Type>::is_list)>::type
     generic_type_from_pointer_vector(Type&, std::vector<void*> const&) {}
 
+    template <typename C, typename = void>
+    struct has_data : std::false_type {};
+
+    template <typename C>
+    struct has_data<
+        C, typename exists<decltype(std::declval<C>().data())>::type>
+        : std::true_type {};
+
+    // Strings, trivially copyable values other than pointers, and arrays or
+    // resizable containers of serializable values.
+    template <typename T, typename = void>
+    struct is_serializable
+        : std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                           !std::is_pointer<T>::value> {};
+
+    template <>
+    struct is_serializable<std::string, void> : std::true_type {};
+
+    template <typename T, std::size_t N>
+    struct is_serializable<T[N], void> : is_serializable<T> {};
+
+    template <typename C>
+    struct is_serializable<
+        C, typename std::enable_if<
+               is_container<C>::value &&
+               !std::is_trivially_copyable<C>::value>::type>
+        : std::integral_constant<
+              bool, has_resize<C>::value &&
+                        is_serializable<typename C::value_type>::value> {};
+
+    template <typename T, bool = is_container<T>::value>
+    struct serial_traits {
+        static constexpr bool serializable = is_serializable<T>::value;
+
+        static constexpr bool bytes =
+            serializable && std::is_trivially_copyable<T>::value;
+
+        static constexpr bool array =
+            serializable && !bytes && std::is_array<T>::value;
+
+        static constexpr bool run = false;
+        static constexpr bool list = false;
+    };
+
+    template <typename T>
+    struct serial_traits<T, true> : serial_traits<T, false> {
+        using value_type = typename T::value_type;
+
+        // Lists of plain values are stored as a single run of bytes.
+        static constexpr bool run =
+            serial_traits<T, false>::serializable &&
+            !serial_traits<T, false>::bytes && has_data<T>::value &&
+            std::is_trivially_copyable<value_type>::value &&
+            !std::is_same<value_type, bool>::value;
+
+        static constexpr bool list =
+            serial_traits<T, false>::serializable &&
+            !serial_traits<T, false>::bytes && !run;
+    };
+
+    inline void binary_write(std::vector<std::uint8_t>& out,
+                             void const* data, std::size_t size) {
+        auto bytes = static_cast<std::uint8_t const*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    inline void binary_read(std::uint8_t const*& in, std::uint8_t const* end,
+                            void* data, std::size_t size) {
+        if (std::size_t(end - in) < size)
+            throw std::out_of_range("Truncated binary data");
+
+        if (size) {
+            std::memcpy(data, in, size);
+            in += size;
+        }
+    }
+
+    // Reads a length prefix, checking that the remaining input can hold
+    // that many elements of at least element_size bytes each.
+    inline std::size_t binary_read_length(std::uint8_t const*& in,
+                                          std::uint8_t const* end,
+                                          std::size_t element_size) {
+        std::uint64_t length;
+        binary_read(in, end, &length, sizeof(length));
+
+        if (length > std::uint64_t(end - in) / element_size)
+            throw std::out_of_range("Truncated binary data");
+
+        return std::size_t(length);
+    }
+
+    inline void generic_type_serialize(std::string const& value,
+                                       std::vector<std::uint8_t>& out) {
+        std::uint64_t length = value.size();
+        binary_write(out, &length, sizeof(length));
+        binary_write(out, value.data(), value.size());
+    }
+
+    inline void generic_type_deserialize(std::string& dest,
+                                         std::uint8_t const*& in,
+                                         std::uint8_t const* end) {
+        auto length = binary_read_length(in, end, 1);
+        dest.assign(reinterpret_cast<char const*>(in), length);
+        in += length;
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<serial_traits<Type>::bytes>::type
+    generic_type_serialize(Type const& value,
+                           std::vector<std::uint8_t>& out) {
+        binary_write(out, &value, sizeof(Type));
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<serial_traits<Type>::bytes>::type
+    generic_type_deserialize(Type& dest, std::uint8_t const*& in,
+                             std::uint8_t const* end) {
+        binary_read(in, end, &dest, sizeof(Type));
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<serial_traits<Type>::run>::type
+    generic_type_serialize(Type const& value,
+                           std::vector<std::uint8_t>& out) {
+        std::uint64_t length = value.size();
+        binary_write(out, &length, sizeof(length));
+        binary_write(out, value.data(),
+                     value.size() * sizeof(typename Type::value_type));
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<serial_traits<Type>::run>::type
+    generic_type_deserialize(Type& dest, std::uint8_t const*& in,
+                             std::uint8_t const* end) {
+        using value_type = typename Type::value_type;
+
+        auto length = binary_read_length(in, end, sizeof(value_type));
+        dest.resize(length);
+
+        if (length)
+            binary_read(in, end, dest.data(), length * sizeof(value_type));
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<serial_traits<Type>::list>::type
+    generic_type_serialize(Type const& value,
+                           std::vector<std::uint8_t>& out) {
+        std::uint64_t length = value.size();
+        binary_write(out, &length, sizeof(length));
+
+        for (typename Type::value_type const& element : value)
+            generic_type_serialize(element, out);
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<serial_traits<Type>::list>::type
+    generic_type_deserialize(Type& dest, std::uint8_t const*& in,
+                             std::uint8_t const* end) {
+        // Every element takes at least one byte.
+        dest.resize(binary_read_length(in, end, 1));
+
+        for (auto it = dest.begin(); it != dest.end(); ++it) {
+            typename Type::value_type element;
+            generic_type_deserialize(element, in, end);
+            *it = std::move(element);
+        }
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<serial_traits<Type>::array>::type
+    generic_type_serialize(Type const& value,
+                           std::vector<std::uint8_t>& out) {
+        for (auto const& element : value)
+            generic_type_serialize(element, out);
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<serial_traits<Type>::array>::type
+    generic_type_deserialize(Type& dest, std::uint8_t const*& in,
+                             std::uint8_t const* end) {
+        for (auto& element : dest)
+            generic_type_deserialize(element, in, end);
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<!is_serializable<Type>::value>::type
+    generic_type_serialize(Type const&, std::vector<std::uint8_t>&) {
+        throw std::logic_error("Type is not serializable");
+    }
+
+    template <typename Type>
+    inline typename std::enable_if<!is_serializable<Type>::value>::type
+    generic_type_deserialize(Type&, std::uint8_t const*&,
+                             std::uint8_t const*) {
+        throw std::logic_error("Type is not serializable");
+    }
+
 } /* namespace detail */
 
 } /* namespace nodal */
@@ -145,10 +145,10 @@ inline std::pair<nodal::graph_link, bool>
 add_edge(nodal::graph_node* u, nodal::graph_node* v,
          std::pair<std::size_t, std::size_t> sockets,
          nodal::graph& g) {
-    nodal::graph_link link(u, sockets.first, v, sockets.second);
-    bool inserted = !g.has(link);
+    auto count = g.link_count();
+    auto const& link = g.link(u, sockets.first, v, sockets.second);
 
-    return { g.link(link), inserted };
+    return { link, g.link_count() != count };
 }
 
 void remove_edge(nodal::graph_node* u, nodal::graph_node* v, nodal::graph& g);
@@ -26,6 +26,9 @@
 
 #include <boost/graph/properties.hpp>
 
+#include <stdexcept>
+#include <type_traits>
+
 namespace boost
 {
 
@@ -37,10 +40,10 @@ public:
     using key_type = nodal::graph_node*;
     using category = lvalue_property_map_tag;
 
-    attribute_property_map(std::string const& attribute)
+    attribute_property_map(nodal::attribute_key attribute)
         : attribute(attribute) {}
 
-    std::string attribute;
+    nodal::attribute_key attribute;
 };
 
 template <typename Value>
@@ -51,10 +54,10 @@ public:
     using key_type = nodal::graph_node const*;
     using category = readable_property_map_tag;
 
-    attribute_property_map(std::string const& attribute)
+    attribute_property_map(nodal::attribute_key attribute)
         : attribute(attribute) {}
 
-    std::string attribute;
+    nodal::attribute_key attribute;
 };
 
 template <typename T, bool Const>
@@ -81,9 +84,138 @@ void put(attribute_property_map<T, false> const& pmap,
     key->attribute(pmap.attribute) = val;
 }
 
+// Maps onto a graph column, created on first use like node attributes.
+template <typename Value, bool Const = false>
+class column_property_map {
+public:
+    using value_type = Value;
+    using reference = value_type&;
+    using key_type = nodal::graph_node const*;
+    using category = lvalue_property_map_tag;
+
+    column_property_map(nodal::graph& g, nodal::attribute_key column)
+        : column(&g.column<Value>(column))
+        {}
+
+    nodal::attribute_column<Value>* column;
+};
+
+// Read-only maps never add a column, so that const graphs shared between
+// threads stay untouched: without the column every node reads as the
+// value a new column would hold.
+template <typename Value>
+class column_property_map<Value, true> {
+public:
+    using value_type = Value;
+    using reference = value_type;
+    using key_type = nodal::graph_node const*;
+    using category = readable_property_map_tag;
+
+    column_property_map(nodal::graph const& g, nodal::attribute_key column)
+        : column(g.find_column<Value>(column))
+        {}
+
+    nodal::attribute_column<Value> const* column;
+};
+
+template <typename T>
+T& get(column_property_map<T, false> const& pmap,
+       nodal::graph_node const* key) {
+    return (*pmap.column)[key];
+}
+
+template <typename T>
+T get(column_property_map<T, true> const& pmap, nodal::graph_node const* key) {
+    return pmap.column ? (*pmap.column)[key] : T();
+}
+
+template <typename T>
+void put(column_property_map<T, false> const& pmap,
+         nodal::graph_node const* key,
+         T const& val) {
+    (*pmap.column)[key] = val;
+}
+
+// Index of a link in g. Copies of stored links carry their index; other
+// links are looked up. Throws std::out_of_range if g has no such link.
+inline std::size_t link_index(nodal::graph const& g,
+                              nodal::graph_link const& link) {
+    if (link.index() != nodal::node_handle::npos)
+        return link.index();
+
+    auto it = g.find(link);
+
+    if (it == g.links_end())
+        throw std::out_of_range("Link not in graph");
+
+    return it->index();
+}
+
+// Maps onto a graph link column, created on first use.
+template <typename Value, bool Const = false>
+class link_column_property_map {
+public:
+    using value_type = Value;
+    using reference = value_type&;
+    using key_type = nodal::graph_link;
+    using category = lvalue_property_map_tag;
+
+    link_column_property_map(nodal::graph& g, nodal::attribute_key column,
+                             Value const& initial = Value())
+        : g(&g), column(&g.link_column<Value>(column, initial))
+        {}
+
+    nodal::graph const* g;
+    nodal::attribute_column<Value>* column;
+};
+
+// Read-only, and like column_property_map<Value, true> never adds the
+// column: without it every link reads as initial.
+template <typename Value>
+class link_column_property_map<Value, true> {
+public:
+    using value_type = Value;
+    using reference = value_type;
+    using key_type = nodal::graph_link;
+    using category = readable_property_map_tag;
+
+    link_column_property_map(nodal::graph const& g,
+                             nodal::attribute_key column,
+                             Value const& initial = Value())
+        : g(&g), column(g.find_link_column<Value>(column)), initial(initial)
+        {}
+
+    nodal::graph const* g;
+    nodal::attribute_column<Value> const* column;
+    Value initial;
+};
+
+template <typename T>
+T& get(link_column_property_map<T, false> const& pmap,
+       nodal::graph_link const& key) {
+    return (*pmap.column)[link_index(*pmap.g, key)];
+}
+
+template <typename T>
+T get(link_column_property_map<T, true> const& pmap,
+      nodal::graph_link const& key) {
+    auto index = link_index(*pmap.g, key);
+    return pmap.column ? (*pmap.column)[index] : pmap.initial;
+}
+
+template <typename T>
+void put(link_column_property_map<T, false> const& pmap,
+         nodal::graph_link const& key,
+         T const& val) {
+    (*pmap.column)[link_index(*pmap.g, key)] = val;
+}
+
+// Specialisations name the attribute backing a property tag. Columnar ones
+// are stored in a graph column rather than in per-node attributes.
 template <typename PropertyTag>
 struct property_tag_to_attribute {
     static constexpr bool mapped = false;
+    static constexpr bool columnar = false;
     static constexpr char const* name = nullptr;
 };
 
@@ -92,10 +224,16 @@ struct property_map<nodal::graph, PropertyTag> {
     using mapped_attribute = property_tag_to_attribute<PropertyTag>;
 
     template <bool Const>
-    class map : public attribute_property_map<typename mapped_attribute::type,
-                                              Const> {
-        using base =
-            attribute_property_map<typename mapped_attribute::type, Const>;
+    using base_map = typename std::conditional<
+        mapped_attribute::columnar,
+        column_property_map<typename mapped_attribute::type, Const>,
+        attribute_property_map<typename mapped_attribute::type, Const>>::type;
+
+    template <bool Const>
+    class map : public base_map<Const> {
+        using base = base_map<Const>;
+        using graph_type = typename std::conditional<
+            Const, nodal::graph const&, nodal::graph&>::type;
 
     public:
         using typename base::category;
@@ -103,7 +241,19 @@ struct property_map<nodal::graph, PropertyTag> {
         using typename base::reference;
         using typename base::value_type;
 
-        map(nodal::graph const&) : base(mapped_attribute::name) {}
+        map(graph_type g) : map(g, base_tag()) {}
+
+    private:
+        using base_tag =
+            std::integral_constant<bool, mapped_attribute::columnar>;
+
+        map(graph_type, std::false_type)
+            : base(mapped_attribute::name)
+            {}
+
+        map(graph_type g, std::true_type)
+            : base(g, mapped_attribute::name)
+            {}
     };
 
     using type = map<false>;
@@ -113,6 +263,7 @@ struct property_map<nodal::graph, PropertyTag> {
 template <>
 struct property_tag_to_attribute<vertex_name_t> {
     static constexpr bool mapped = true;
+    static constexpr bool columnar = false;
     static constexpr char const* name = "name";
     using type = std::string;
 };
@@ -120,6 +271,7 @@ struct property_tag_to_attribute<vertex_name_t> {
 template <>
 struct property_tag_to_attribute<vertex_distance_t> {
     static constexpr bool mapped = true;
+    static constexpr bool columnar = true;
     static constexpr char const* name = "distance";
     using type = double;
 };
@@ -127,6 +279,7 @@ struct property_tag_to_attribute<vertex_distance_t> {
 template <>
 struct property_tag_to_attribute<vertex_color_t> {
     static constexpr bool mapped = true;
+    static constexpr bool columnar = true;
     static constexpr char const* name = "color";
     using type = default_color_type;
 };
@@ -134,6 +287,7 @@ struct property_tag_to_attribute<vertex_color_t> {
 template <>
 struct property_tag_to_attribute<vertex_discover_time_t> {
     static constexpr bool mapped = true;
+    static constexpr bool columnar = true;
     static constexpr char const* name = "discover_time";
     using type = std::size_t;
 };
@@ -141,30 +295,25 @@ struct property_tag_to_attribute<vertex_discover_time_t> {
 template <>
 struct property_tag_to_attribute<vertex_finish_time_t> {
     static constexpr bool mapped = true;
+    static constexpr bool columnar = true;
     static constexpr char const* name = "finish_time";
     using type = std::size_t;
 };
 
 template <>
 struct property_map<nodal::graph, vertex_index_t> {
-    using iter_diff_type =
-        std::iterator_traits<nodal::graph::node_iterator>::difference_type;
-
-    class const_type : public put_get_helper<iter_diff_type, const_type> {
+    class const_type : public put_get_helper<std::size_t, const_type> {
     public:
-        using value_type = iter_diff_type;
+        using value_type = std::size_t;
         using reference = value_type;
         using key_type = nodal::graph_node*;
         using category = readable_property_map_tag;
 
-        const_type(nodal::graph const& g) : g(&g) {}
+        const_type(nodal::graph const&) {}
 
         reference operator[](key_type const& node) const {
-            return std::distance(g->nodes_begin(), g->find(node));
+            return node->index();
         }
-
-    private:
-        nodal::graph const* g;
     };
 
     using type = const_type;
@@ -172,12 +321,9 @@ struct property_map<nodal::graph, vertex_index_t> {
 
 template <>
 struct property_map<nodal::graph, edge_index_t> {
-    using iter_diff_type =
-        std::iterator_traits<nodal::graph::link_iterator>::difference_type;
-
-    class const_type : public put_get_helper<iter_diff_type, const_type> {
+    class const_type : public put_get_helper<std::size_t, const_type> {
     public:
-        using value_type = iter_diff_type;
+        using value_type = std::size_t;
         using reference = value_type;
         using key_type = nodal::graph_link;
         using category = readable_property_map_tag;
@@ -185,7 +331,7 @@ struct property_map<nodal::graph, edge_index_t> {
         const_type(nodal::graph const& g) : g(&g) {}
 
         reference operator[](key_type const& link) const {
-            return std::distance(g->links_begin(), g->find(link));
+            return link_index(*g, link);
         }
 
     private:
@@ -195,23 +341,23 @@ struct property_map<nodal::graph, edge_index_t> {
     using type = const_type;
 };
 
+// Link weights live in the "weight" link column, where links weigh 1
+// unless set otherwise.
 template <>
 struct property_map<nodal::graph, edge_weight_t> {
-    class const_type : public put_get_helper<double, const_type> {
-    public:
-        using value_type = double;
-        using reference = value_type;
-        using key_type = nodal::graph_link;
-        using category = readable_property_map_tag;
-
-        const_type(nodal::graph const&) {}
+    template <bool Const>
+    class map : public link_column_property_map<double, Const> {
+        using graph_type = typename std::conditional<
+            Const, nodal::graph const&, nodal::graph&>::type;
 
-        reference operator[](key_type const&) const {
-            return 1.0;
-        }
+    public:
+        map(graph_type g)
+            : link_column_property_map<double, Const>(g, "weight", 1.0)
+            {}
     };
 
-    using type = const_type;
+    using type = map<false>;
+    using const_type = map<true>;
 };
 
 template <typename PropertyTag>
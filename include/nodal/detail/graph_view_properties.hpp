@@ -0,0 +1,150 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <boost/graph/properties.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace boost
+{
+
+// Node and link attributes are shared with the base graph. Writable maps
+// of a non-const view write to the base graph, and may add columns to it.
+template <typename PropertyTag>
+struct property_map<nodal::graph_view, PropertyTag> {
+    using base_map = property_map<nodal::graph, PropertyTag>;
+
+    class type : public base_map::type {
+    public:
+        type(nodal::graph_view& g)
+            : base_map::type(const_cast<nodal::graph&>(g.base()))
+            {}
+    };
+
+    class const_type : public base_map::const_type {
+    public:
+        const_type(nodal::graph_view const& g)
+            : base_map::const_type(g.base())
+            {}
+    };
+};
+
+template <>
+struct property_map<nodal::graph_view, vertex_index_t> {
+    class const_type : public put_get_helper<std::size_t, const_type> {
+    public:
+        using value_type = std::size_t;
+        using reference = value_type;
+        using key_type = nodal::graph_node*;
+        using category = readable_property_map_tag;
+
+        const_type(nodal::graph_view const& g) : g(&g) {}
+
+        reference operator[](key_type const& node) const {
+            return g->id(node);
+        }
+
+    private:
+        nodal::graph_view const* g;
+    };
+
+    using type = const_type;
+};
+
+// Links are numbered in [0, num_edges(view)) in the order edges() visits
+// them, once when the map is created; copies share the numbering.
+template <>
+struct property_map<nodal::graph_view, edge_index_t> {
+    class const_type : public put_get_helper<std::size_t, const_type> {
+    public:
+        using value_type = std::size_t;
+        using reference = value_type;
+        using key_type = nodal::graph_link;
+        using category = readable_property_map_tag;
+
+        const_type(nodal::graph_view const& g)
+            : g(&g), ids(std::make_shared<id_map>())
+        {
+            for (auto const& link : make_iterator_range(g.links()))
+                ids->emplace(link_index(g.base(), link), ids->size());
+        }
+
+        // Throws std::out_of_range if the link is not in the view.
+        reference operator[](key_type const& link) const {
+            auto it = ids->find(link_index(g->base(), link));
+
+            if (it == ids->end())
+                throw std::out_of_range("Link not in view");
+
+            return it->second;
+        }
+
+    private:
+        using id_map = std::unordered_map<std::size_t, std::size_t>;
+
+        nodal::graph_view const* g;
+        std::shared_ptr<id_map> ids;
+    };
+
+    using type = const_type;
+};
+
+template <typename PropertyTag>
+inline typename property_map<nodal::graph_view, PropertyTag>::type
+get(PropertyTag, nodal::graph_view& g) {
+    return typename property_map<nodal::graph_view, PropertyTag>::type(g);
+}
+
+template <typename PropertyTag>
+inline typename property_map<nodal::graph_view, PropertyTag>::const_type
+get(PropertyTag, nodal::graph_view const& g) {
+    return
+        typename property_map<nodal::graph_view, PropertyTag>::const_type(g);
+}
+
+template <typename PropertyTag, typename Key>
+inline typename property_map<nodal::graph_view, PropertyTag>::type::reference
+get(PropertyTag p, nodal::graph_view& g, Key&& x) {
+    return get(get(p, g), std::forward<Key>(x));
+}
+
+template <typename PropertyTag, typename Key>
+inline
+typename property_map<nodal::graph_view, PropertyTag>::const_type::reference
+get(PropertyTag p, nodal::graph_view const& g, Key&& x) {
+    return get(get(p, g), std::forward<Key>(x));
+}
+
+template <typename PropertyTag, typename Key, typename Value>
+inline void put(PropertyTag p, nodal::graph_view& g, Key&& x, Value&& v) {
+    put(get(p, g), std::forward<Key>(x), std::forward<Value>(v));
+}
+
+} /* namespace boost */
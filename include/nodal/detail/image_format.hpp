@@ -0,0 +1,141 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    constexpr char image_magic[8] = { 'N', 'O', 'D', 'A', 'L', 'I', 'M', 'G' };
+    constexpr std::uint32_t image_version = 1;
+    constexpr std::uint32_t image_byte_order = 0x01020304;
+
+    // Sections start at multiples of this many bytes from the file start.
+    constexpr std::size_t image_alignment = 16;
+
+    // Marks serialized blocks in the data size table.
+    constexpr std::uint32_t image_serialized_flag = std::uint32_t(1) << 31;
+
+    inline std::uint64_t image_align(std::uint64_t offset) {
+        return (offset + image_alignment - 1) & ~(image_alignment - 1);
+    }
+
+    // Leading block of a graph image file, see graph_image.hpp.
+    struct image_header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+        std::uint32_t link_size;
+        std::uint32_t reserved;
+
+        std::uint64_t node_count;
+        std::uint64_t link_count;
+
+        // File offsets of the sections, in file order.
+        std::uint64_t types;
+        std::uint64_t output_offsets;
+        std::uint64_t links;
+        std::uint64_t input_offsets;
+        std::uint64_t input_index;
+        std::uint64_t data_offsets;
+        std::uint64_t data_sizes;
+        std::uint64_t data;
+
+        std::uint64_t size;
+
+        // Header of this build's format for an image of the given size,
+        // with all section offsets zero.
+        static image_header create(std::uint64_t node_count,
+                                   std::uint64_t link_count);
+
+        // Whether the header belongs to an image this build can read, with
+        // every section inside a file of file_size bytes.
+        bool valid(std::uint64_t file_size) const;
+    };
+
+    // Sequential writer that pads every section to image_alignment.
+    class image_writer {
+    public:
+        explicit image_writer(std::string const& path)
+            : path(path), out(path, std::ios::binary | std::ios::trunc)
+        {
+            if (!out)
+                throw std::system_error(errno, std::generic_category(), path);
+        }
+
+        std::uint64_t offset() const {
+            return offset_;
+        }
+
+        std::uint64_t begin_section() {
+            static char const zeros[image_alignment] = {};
+
+            auto next = image_align(offset_);
+            write(zeros, next - offset_);
+
+            return offset_;
+        }
+
+        void write(void const* data, std::size_t size) {
+            out.write(static_cast<char const*>(data), std::streamsize(size));
+            offset_ += size;
+        }
+
+        template <typename T>
+        std::uint64_t section(std::vector<T> const& values) {
+            auto start = begin_section();
+            write(values.data(), values.size() * sizeof(T));
+            return start;
+        }
+
+        void finish(image_header const& header) {
+            out.seekp(0);
+            out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            out.flush();
+
+            if (!out)
+                throw std::system_error(errno, std::generic_category(), path);
+        }
+
+    private:
+        std::string path;
+        std::ofstream out;
+        std::uint64_t offset_ = 0;
+    };
+
+} /* namespace detail */
+
+} /* namespace nodal */
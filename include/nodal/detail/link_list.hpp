@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include "arena_allocator.hpp"
+
+#include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/member.hpp>
@@ -50,10 +53,21 @@ namespace detail
                 hashed_unique<identity<graph_link>, graph_link::hash>,
                 ordered_non_unique<
                     tag<source_index>,
-                    member<graph_link, graph_node*, &graph_link::source_node>>,
+                    composite_key<
+                        graph_link,
+                        member<graph_link, graph_node*,
+                               &graph_link::source_node>,
+                        member<graph_link, socket_index,
+                               &graph_link::source_socket>>>,
                 ordered_non_unique<
                     tag<target_index>,
-                    member<graph_link, graph_node*, &graph_link::target_node>>>>;
+                    composite_key<
+                        graph_link,
+                        member<graph_link, graph_node*,
+                               &graph_link::target_node>,
+                        member<graph_link, socket_index,
+                               &graph_link::target_socket>>>>,
+            arena_allocator<graph_link>>;
 
     } /* namespace link_list_detail */
 
@@ -0,0 +1,257 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    // Slot map of graph nodes. Nodes are kept packed in a vector so that
+    // each node's position doubles as its vertex index; a separate slot
+    // table maps stable handles to positions, with a generation counter
+    // per slot to detect handles to removed nodes.
+    class node_list {
+    public:
+        using const_iterator = std::vector<graph_node*>::const_iterator;
+
+        const_iterator begin() const {
+            return nodes.cbegin();
+        }
+
+        const_iterator end() const {
+            return nodes.cend();
+        }
+
+        std::size_t size() const {
+            return nodes.size();
+        }
+
+        bool empty() const {
+            return nodes.empty();
+        }
+
+        graph_node* operator[](std::size_t index) const {
+            return nodes[index];
+        }
+
+        void reserve(std::size_t count) {
+            nodes.reserve(count);
+        }
+
+        bool contains(graph_node const* node) const {
+            return node && node->index_ < nodes.size() &&
+                   nodes[node->index_] == node;
+        }
+
+        const_iterator find(graph_node const* node) const {
+            return contains(node) ? nodes.cbegin() + node->index_
+                                  : nodes.cend();
+        }
+
+        graph_node* find(node_handle handle) const {
+            if (handle.id >= slots.size())
+                return nullptr;
+
+            auto const& s = slots[handle.id];
+            if (s.index == node_handle::npos ||
+                s.generation != handle.generation)
+                return nullptr;
+
+            return nodes[s.index];
+        }
+
+        void insert(graph_node* node) {
+            if (nodes.size() >= node_handle::npos)
+                throw std::length_error("Too many nodes in graph");
+
+            std::uint32_t id;
+
+            if (free.empty()) {
+                id = static_cast<std::uint32_t>(slots.size());
+                slots.push_back({ node_handle::npos, 0 });
+            } else {
+                id = free.back();
+                free.pop_back();
+            }
+
+            auto& s = slots[id];
+            s.index = static_cast<std::uint32_t>(nodes.size());
+
+            node->index_ = s.index;
+            node->handle_ = { id, s.generation };
+
+            nodes.push_back(node);
+        }
+
+        // Put node in place of the one at pos, taking over its index and
+        // handle. Used when duplicating a whole graph.
+        void replace(const_iterator pos, graph_node* node) {
+            auto index = pos - nodes.cbegin();
+            auto old = nodes[index];
+
+            node->index_ = old->index_;
+            node->handle_ = old->handle_;
+
+            nodes[index] = node;
+        }
+
+        // Remove the node at pos by moving the last node into its place.
+        // Returns an iterator to the moved node, or end() if pos was the
+        // last position.
+        template <typename Disposer>
+        const_iterator erase_and_dispose(const_iterator pos,
+                                         Disposer dispose) {
+            auto index = pos - nodes.cbegin();
+            auto node = nodes[index];
+
+            release(node);
+
+            if (std::size_t(index) + 1 < nodes.size()) {
+                nodes[index] = nodes.back();
+                nodes[index]->index_ = static_cast<std::uint32_t>(index);
+                slots[nodes[index]->handle_.id].index = nodes[index]->index_;
+            }
+
+            nodes.pop_back();
+            dispose(node);
+
+            return nodes.cbegin() + index;
+        }
+
+        // Remove the nodes in [first, last), preserving the order of the
+        // remaining ones. Returns an iterator to the node following the
+        // removed range.
+        template <typename Disposer>
+        const_iterator erase_and_dispose(const_iterator first,
+                                         const_iterator last,
+                                         Disposer dispose) {
+            auto index = first - nodes.cbegin();
+
+            for (auto it = first; it != last; ++it) {
+                release(*it);
+                dispose(*it);
+            }
+
+            nodes.erase(first, last);
+
+            for (auto i = std::size_t(index); i < nodes.size(); ++i) {
+                nodes[i]->index_ = static_cast<std::uint32_t>(i);
+                slots[nodes[i]->handle_.id].index = nodes[i]->index_;
+            }
+
+            return nodes.cbegin() + index;
+        }
+
+        // Remove the nodes whose index is set in mask in a single pass,
+        // preserving the order of the remaining ones.
+        template <typename Disposer>
+        void erase_and_dispose(boost::dynamic_bitset<> const& mask,
+                               Disposer dispose) {
+            std::size_t kept = 0;
+
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                auto node = nodes[i];
+
+                if (i < mask.size() && mask[i]) {
+                    release(node);
+                    dispose(node);
+                } else {
+                    if (kept != i) {
+                        nodes[kept] = node;
+                        node->index_ = static_cast<std::uint32_t>(kept);
+                        slots[node->handle_.id].index = node->index_;
+                    }
+
+                    ++kept;
+                }
+            }
+
+            nodes.resize(kept);
+        }
+
+        // Replace the node at index order[i] with copies[i] for every i,
+        // placing it at index i; each copy takes over the handle of the
+        // node it replaces. order must be a permutation of the indices.
+        void reorder(std::vector<std::uint32_t> const& order,
+                     std::vector<graph_node*> const& copies) {
+            for (std::size_t i = 0; i < copies.size(); ++i) {
+                auto node = copies[i];
+
+                node->index_ = static_cast<std::uint32_t>(i);
+                node->handle_ = nodes[order[i]]->handle_;
+                slots[node->handle_.id].index = node->index_;
+            }
+
+            nodes = copies;
+        }
+
+        template <typename Disposer>
+        void clear_and_dispose(Disposer dispose) {
+            for (auto node : nodes) {
+                release(node);
+                dispose(node);
+            }
+
+            nodes.clear();
+        }
+
+        void swap(node_list& other) {
+            nodes.swap(other.nodes);
+            slots.swap(other.slots);
+            free.swap(other.free);
+        }
+
+    private:
+        struct slot {
+            std::uint32_t index;
+            std::uint32_t generation;
+        };
+
+        void release(graph_node* node) {
+            auto& s = slots[node->handle_.id];
+            s.index = node_handle::npos;
+            ++s.generation;
+
+            free.push_back(node->handle_.id);
+        }
+
+        std::vector<graph_node*> nodes;
+        std::vector<slot> slots;
+        std::vector<std::uint32_t> free;
+    };
+
+} /* namespace detail */
+
+} /* namespace nodal */
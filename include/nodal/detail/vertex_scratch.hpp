@@ -0,0 +1,70 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+
+#include <vector>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    // Vertex property storage for a single algorithm run: a vector indexed
+    // by vertex index, released with the run instead of left on the graph
+    // as attributes or columns. Colours, discover and finish times and
+    // distances used by passes should live here.
+    template <typename T, typename Graph>
+    class vertex_scratch {
+    public:
+        using index_map = typename boost::property_map<
+            Graph, boost::vertex_index_t>::const_type;
+        using map_type = boost::iterator_property_map<
+            typename std::vector<T>::iterator, index_map>;
+
+        explicit vertex_scratch(Graph const& g, T const& value = T())
+            : values(boost::num_vertices(g), value),
+              index(boost::get(boost::vertex_index, g))
+            {}
+
+        vertex_scratch(vertex_scratch const&) = delete;
+        vertex_scratch& operator=(vertex_scratch const&) = delete;
+
+        map_type map() {
+            return map_type(values.begin(), index);
+        }
+
+    private:
+        std::vector<T> values;
+        index_map index;
+    };
+
+} /* namespace detail */
+
+} /* namespace nodal */
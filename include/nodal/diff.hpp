@@ -0,0 +1,108 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "frozen_graph.hpp"
+#include "graph.hpp"
+
+#include "detail/data_encoding.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace nodal
+{
+
+// Difference between two graphs. Nodes are referred to by position:
+// references below base_nodes are indices of nodes in the original graph,
+// and reference base_nodes + i is the i-th entry of added_nodes. Node
+// types are ids into a type table shared by both ends, as for graph
+// images, and data is stored as in graph images, so that a patch can be
+// encoded and sent to another process.
+//
+// Applying a patch rearranges node positions in a deterministic way, so a
+// sender that keeps its own copy of the receiver's graph up to date with
+// apply() can keep computing patches against it.
+struct patch {
+    struct data_change {
+        std::uint32_t node;
+
+        // New data of the node; encoding none drops the node's data.
+        detail::data_encoding encoding;
+        std::vector<std::uint8_t> data;
+    };
+
+    std::uint32_t base_nodes = 0;
+
+    std::vector<std::uint32_t> removed_nodes;
+    std::vector<std::uint32_t> added_nodes;
+
+    std::vector<frozen_link> removed_links;
+    std::vector<frozen_link> added_links;
+
+    std::vector<data_change> data_changes;
+
+    bool empty() const {
+        return removed_nodes.empty() && added_nodes.empty() &&
+               removed_links.empty() && added_links.empty() &&
+               data_changes.empty();
+    }
+
+    // Binary form of the patch, independent of NODAL_COMPACT_LINKS.
+    std::vector<std::uint8_t> encode() const;
+
+    // Throws std::invalid_argument if data is not an encoded patch, and
+    // std::out_of_range if it is truncated.
+    static patch decode(std::uint8_t const* data, std::size_t size);
+};
+
+// Compute the patch that turns from into to. Nodes are paired first by
+// the value of the identity attribute, when given and holding a string;
+// then by equal fingerprints upstream and downstream, by equal upstream
+// fingerprints, by equal node and inputs from paired nodes, and finally by
+// equal node alone. Paired nodes whose data differ produce a data change
+// carrying the new data.
+//
+// Any pairing yields a correct patch; the heuristics above only keep it
+// small.
+//
+// Throws std::invalid_argument if an added node's type is not in types,
+// or if changed data is neither raw-copyable nor held by a typed node,
+// and std::logic_error if such data holds a value its type cannot
+// serialize.
+patch diff(graph const& from, graph const& to,
+           std::vector<node const*> const& types,
+           attribute_key const& identity = attribute_key());
+
+// Replay a patch on a graph with the same node positions as the graph it
+// was computed from, with the same type table. Throws
+// std::invalid_argument if the node count does not match or data does not
+// fit its node, and std::out_of_range for references past the patch's
+// nodes or types. A patch that throws leaves the graph untouched.
+void apply(graph& graph, patch const& patch,
+           std::vector<node const*> const& types);
+
+} /* namespace nodal */
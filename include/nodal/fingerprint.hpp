@@ -0,0 +1,113 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "graph.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace nodal
+{
+
+struct fingerprint {
+    std::uint64_t low = 0;
+    std::uint64_t high = 0;
+
+    bool operator==(fingerprint const& other) const {
+        return low == other.low && high == other.high;
+    }
+
+    bool operator!=(fingerprint const& other) const {
+        return !(*this == other);
+    }
+};
+
+// Content hash of a graph, independent of node order, handles and
+// addresses. Each node is hashed from the dynamic type of its node, its
+// socket counts and, for typed nodes, its input and parameter values as
+// read through their types; the hash of each incoming link, which includes
+// the hash of its source node, is then folded in, Merkle-style. The graph
+// fingerprint is the sum of all node hashes.
+//
+// Object values are not hashed, and nodes that are not typed_nodes
+// contribute no data. The hash is not cryptographic.
+//
+// Values are those of the last call to update(). When the graph has a
+// journal, update() replays its events and rehashes only the changed nodes
+// and their descendants. Without a journal, after lost events, and while
+// the graph has cycles, it rehashes everything.
+class graph_fingerprint {
+public:
+    explicit graph_fingerprint(graph const& graph);
+
+    // Bring the fingerprint up to date with the graph.
+    void update();
+    void rehash();
+
+    fingerprint value() const {
+        return total;
+    }
+
+    fingerprint value(graph_node const* node) const;
+
+    // Hash of the node alone, without its incoming links.
+    fingerprint local_value(graph_node const* node) const;
+
+private:
+    struct entry {
+        std::uint32_t generation = 0;
+        std::uint32_t mark = 0;
+        std::uint32_t pending = 0;
+        bool valid = false;
+        bool local_valid = false;
+        fingerprint local;
+        fingerprint full;
+    };
+
+    entry const& find(graph_node const* node) const;
+    entry& at(node_handle handle);
+    void touch(node_handle handle, bool data);
+    void forget(node_handle handle);
+    void propagate(bool full);
+    void assign(graph_node* node, fingerprint const& hash);
+
+    fingerprint const& local(graph_node* node);
+    fingerprint hash(graph_node* node, bool shallow);
+
+    graph const& graph_;
+    graph_journal const* journal;
+    graph_journal::cursor cursor;
+
+    std::vector<entry> entries;
+    std::vector<node_handle> dirty;
+    std::uint32_t epoch = 0;
+    bool cyclic = false;
+
+    fingerprint total;
+};
+
+} /* namespace nodal */
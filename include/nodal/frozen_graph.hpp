@@ -0,0 +1,191 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "graph.hpp"
+
+#include <boost/iterator/counting_iterator.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace nodal
+{
+
+// Frozen sockets are as narrow as socket_index, but never wider than
+// 32 bits: 16 bytes per link by default, 12 with NODAL_COMPACT_LINKS.
+using frozen_socket =
+    std::conditional_t<(sizeof(socket_index) < sizeof(std::uint32_t)),
+                       socket_index, std::uint32_t>;
+
+struct frozen_link {
+    frozen_link() = default;
+
+    frozen_link(std::uint32_t source_node, std::uint32_t source_socket,
+                std::uint32_t target_node, std::uint32_t target_socket)
+        : source_node(source_node), target_node(target_node),
+          source_socket(detail::narrow_socket<frozen_socket>(source_socket)),
+          target_socket(detail::narrow_socket<frozen_socket>(target_socket))
+        {}
+
+    std::uint32_t source_node;
+    std::uint32_t target_node;
+
+    frozen_socket source_socket;
+    frozen_socket target_socket;
+};
+
+// Immutable snapshot of a graph's structure in compressed sparse row form.
+// Nodes and links are identified by dense 32-bit ids; links are stored
+// sorted by (source node, source socket), with a second index sorted by
+// (target node, target socket). The snapshot refers to the graph's nodes
+// and must not outlive them.
+class frozen_graph {
+public:
+    using node_id = std::uint32_t;
+    using link_id = std::uint32_t;
+
+    static constexpr std::uint32_t npos =
+        std::numeric_limits<std::uint32_t>::max();
+
+    using node_iterator = boost::counting_iterator<node_id>;
+    using node_range    = std::pair<node_iterator, node_iterator>;
+
+    using link_iterator = boost::counting_iterator<link_id>;
+    using link_range    = std::pair<link_iterator, link_iterator>;
+
+    using input_link_iterator = link_id const*;
+    using input_link_range =
+        std::pair<input_link_iterator, input_link_iterator>;
+
+    using output_link_iterator = link_iterator;
+    using output_link_range    = link_range;
+
+    frozen_graph() = default;
+    explicit frozen_graph(graph const& graph);
+
+    graph_node* node(node_id id) const {
+        return nodes_[id];
+    }
+
+    node_id id(graph_node const* node) const {
+        return (node && node->index() < nodes_.size() &&
+                nodes_[node->index()] == node)
+                   ? node_id(node->index())
+                   : npos;
+    }
+
+    node_iterator nodes_begin() const {
+        return node_iterator(0);
+    }
+
+    node_iterator nodes_end() const {
+        return node_iterator(node_id(nodes_.size()));
+    }
+
+    node_range nodes() const {
+        return { nodes_begin(), nodes_end() };
+    }
+
+    std::size_t node_count() const {
+        return nodes_.size();
+    }
+
+    frozen_link const& link(link_id id) const {
+        return links_[id];
+    }
+
+    link_iterator links_begin() const {
+        return link_iterator(0);
+    }
+
+    link_iterator links_end() const {
+        return link_iterator(link_id(links_.size()));
+    }
+
+    link_range links() const {
+        return { links_begin(), links_end() };
+    }
+
+    std::size_t link_count() const {
+        return links_.size();
+    }
+
+    input_link_range input_links(node_id node) const {
+        return { input_index_.data() + input_offsets_[node],
+                 input_index_.data() + input_offsets_[node + 1] };
+    }
+
+    // Link connected to the given input socket, or npos if there is none.
+    link_id input_link(node_id node, std::uint32_t socket) const {
+        auto range = input_links(node, socket);
+        return (range.first != range.second) ? *range.first : npos;
+    }
+
+    input_link_range input_links(node_id node, std::uint32_t socket) const;
+
+    std::size_t input_degree(node_id node) const {
+        return input_offsets_[node + 1] - input_offsets_[node];
+    }
+
+    output_link_range output_links(node_id node) const {
+        return { link_iterator(output_offsets_[node]),
+                 link_iterator(output_offsets_[node + 1]) };
+    }
+
+    output_link_range output_links(node_id node, std::uint32_t socket) const;
+
+    std::size_t output_degree(node_id node) const {
+        return output_offsets_[node + 1] - output_offsets_[node];
+    }
+
+    std::size_t degree(node_id node) const {
+        return input_degree(node) + output_degree(node);
+    }
+
+private:
+    friend class graph_builder;
+
+    // Links must be sorted by (source node, source socket).
+    frozen_graph(std::vector<graph_node*> nodes,
+                 std::vector<frozen_link> links);
+
+    void build_input_index();
+
+    std::vector<graph_node*> nodes_;
+    std::vector<frozen_link> links_;
+
+    std::vector<std::uint32_t> output_offsets_;
+    std::vector<std::uint32_t> input_offsets_;
+    std::vector<link_id> input_index_;
+};
+
+} /* namespace nodal */
+
+#include "detail/frozen_graph_access.hpp"
+#include "detail/csr_graph_properties.hpp"
@@ -24,17 +24,30 @@
 
 #pragma once
 
+#include "arena.hpp"
+#include "attribute_column.hpp"
+#include "graph_journal.hpp"
 #include "graph_link.hpp"
 #include "graph_node.hpp"
 
-#include <set>
+#include <boost/dynamic_bitset.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace nodal
 {
 
+class frozen_graph;
+
+struct arena_mode_t {};
+constexpr arena_mode_t arena_mode {};
+
 class graph {
 public:
-    using node_iterator = std::set<graph_node*>::const_iterator;
+    using node_iterator = detail::node_list::const_iterator;
     using node_range    = std::pair<node_iterator, node_iterator>;
 
     using link_iterator = detail::link_list::const_iterator;
@@ -52,6 +65,12 @@ public:
 
     graph() = default;
 
+    // Allocate nodes, node data, attributes and links from a private arena.
+    // Individual removals leave their memory in the arena until clear() or
+    // destruction, which release it all at once.
+    explicit graph(arena_mode_t,
+                   std::size_t chunk_size = arena::default_chunk_size);
+
     graph(graph const& other);
     graph(graph&& other);
 
@@ -60,40 +79,90 @@ public:
     graph& operator=(graph const&);
     graph& operator=(graph&&);
 
-    void clear();
-    void clear_links() {
-        links_.clear();
+    // Build an immutable compressed snapshot of the graph's structure.
+    // See frozen_graph.hpp.
+    frozen_graph freeze() const;
+
+    bool uses_arena() const {
+        return bool(arena_);
     }
 
+    // Start recording mutations into a journal holding the last capacity
+    // events. Enabling an already enabled journal discards its contents.
+    // Copies of the graph do not inherit the journal.
+    void enable_journal(
+        std::size_t capacity = graph_journal::default_capacity);
+    void disable_journal();
+
+    graph_journal const* journal() const {
+        return journal_.get();
+    }
+
+    void clear();
+    void clear_links();
+
     graph_node* add(graph_node* node) {
-        if (node)
+        if (node && !nodes_.contains(node)) {
             nodes_.insert(node);
+            attach(node);
+            grow_columns();
+        }
 
         return node;
     }
 
-    graph_node* add(class node const* node) {
-        return *nodes_.emplace(new graph_node(node)).first;
-    }
+    graph_node* add(class node const* node);
 
     node_iterator remove(node_iterator iter);
     node_iterator remove(node_range range);
     void remove(graph_node* node);
 
+    // Remove the nodes whose index() is set in mask, and their links, in
+    // one sweep over the nodes and links rather than node by node. The
+    // remaining nodes keep their order. Throws std::out_of_range if mask
+    // is larger than the graph.
+    void remove(boost::dynamic_bitset<> const& mask);
+
+    template <typename Predicate>
+    void remove_if(Predicate pred) {
+        boost::dynamic_bitset<> mask(nodes_.size());
+
+        for (std::size_t i = 0; i < nodes_.size(); ++i) {
+            if (pred(nodes_[i]))
+                mask.set(i);
+        }
+
+        remove(mask);
+    }
+
+    // Move every node into one block in the given order, so that they sit
+    // next to each other in memory, and renumber nodes and links to match:
+    // order[i] gets index i, and links are indexed by source. Node data is
+    // not moved, so it stays shared with copies of the graph. Handles stay
+    // valid; pointers to the old nodes, and views, snapshots and iterators
+    // over them, do not. In arena mode the block, and the old nodes, stay
+    // in the arena until clear(). Throws std::invalid_argument unless order
+    // holds every node of the graph once. See node_order.hpp.
+    void compact(std::vector<graph_node*> const& order);
+
     node_iterator find(graph_node* node) const {
         return nodes_.find(node);
     }
 
+    graph_node* find(node_handle handle) const {
+        return nodes_.find(handle);
+    }
+
     node_iterator nodes_begin() const {
-        return nodes_.cbegin();
+        return nodes_.begin();
     }
 
     node_iterator nodes_end() const {
-        return nodes_.cend();
+        return nodes_.end();
     }
 
     node_range nodes() const {
-        return { nodes_.cbegin(), nodes_.cend() };
+        return { nodes_.begin(), nodes_.end() };
     }
 
     std::size_t node_count() const {
@@ -101,7 +170,11 @@ public:
     }
 
     bool has(graph_node* node) const {
-        return nodes_.count(node);
+        return nodes_.contains(node);
+    }
+
+    bool has(node_handle handle) const {
+        return nodes_.find(handle) != nullptr;
     }
 
     graph_link const& link(graph_link const& link);
@@ -117,33 +190,42 @@ public:
                            graph_node* target_node, std::size_t target_socket);
 
     link_iterator unlink(link_iterator iter) {
+        retire(*iter);
         return links_.erase(iter);
     }
 
     link_iterator unlink(link_range range) {
+        retire(range);
         return links_.erase(range.first, range.second);
     }
 
     input_link_iterator unlink(input_link_iterator iter) {
+        retire(*iter);
         return links_.get<detail::target_index>().erase(iter);
     }
 
     input_link_iterator unlink(input_link_range range) {
+        retire(range);
         return links_.get<detail::target_index>()
             .erase(range.first, range.second);
     }
 
     output_link_iterator unlink(output_link_iterator iter) {
+        retire(*iter);
         return links_.get<detail::source_index>().erase(iter);
     }
 
     output_link_iterator unlink(output_link_range range) {
+        retire(range);
         return links_.get<detail::source_index>()
             .erase(range.first, range.second);
     }
 
-    void unlink(graph_link link) {
-        links_.erase(link);
+    void unlink(graph_link const& link) {
+        auto it = links_.find(link);
+
+        if (it != links_.end())
+            unlink(it);
     }
 
     void unlink(node_iterator iter) {
@@ -164,7 +246,7 @@ public:
     void unlink_inputs(node_range range);
 
     void unlink_inputs(graph_node* node) {
-        links_.get<detail::target_index>().erase(node);
+        unlink(input_links(node));
     }
 
     void unlink_outputs(node_iterator iter) {
@@ -174,7 +256,7 @@ public:
     void unlink_outputs(node_range range);
 
     void unlink_outputs(graph_node* node) {
-        links_.get<detail::source_index>().erase(node);
+        unlink(output_links(node));
     }
 
     void unlink_input(node_iterator iter, std::size_t socket) {
@@ -193,6 +275,11 @@ public:
         return links_.find(link);
     }
 
+    // Link at the given index(), in [0, link_count()).
+    graph_link const& link_at(std::size_t index) const {
+        return *link_index_[index];
+    }
+
     link_iterator links_begin() const {
         return links_.cbegin();
     }
@@ -221,6 +308,38 @@ public:
         return links_.get<detail::target_index>().equal_range(node);
     }
 
+    graph_link const* input_link(node_iterator iter,
+                                 std::size_t socket) const {
+        return input_link(*iter, socket);
+    }
+
+    // Link connected to the given input socket, or nullptr if there is none.
+    graph_link const* input_link(graph_node* node, std::size_t socket) const {
+        if (!detail::socket_fits<socket_index>(socket))
+            return nullptr;
+
+        auto const& index = links_.get<detail::target_index>();
+        auto it = index.find(boost::make_tuple(node, socket));
+
+        return (it != index.end()) ? &*it : nullptr;
+    }
+
+    input_link_range input_links(node_iterator iter,
+                                 std::size_t socket) const {
+        return input_links(*iter, socket);
+    }
+
+    // Links into the given input socket; empty for sockets that no link
+    // can reach, rather than those of a truncated socket index.
+    input_link_range input_links(graph_node* node, std::size_t socket) const {
+        auto const& index = links_.get<detail::target_index>();
+
+        if (!detail::socket_fits<socket_index>(socket))
+            return { index.end(), index.end() };
+
+        return index.equal_range(boost::make_tuple(node, socket));
+    }
+
     std::size_t input_degree(node_iterator iter) const {
         return input_degree(*iter);
     }
@@ -237,6 +356,21 @@ public:
         return links_.get<detail::source_index>().equal_range(node);
     }
 
+    output_link_range output_links(node_iterator iter,
+                                   std::size_t socket) const {
+        return output_links(*iter, socket);
+    }
+
+    output_link_range output_links(graph_node* node,
+                                   std::size_t socket) const {
+        auto const& index = links_.get<detail::source_index>();
+
+        if (!detail::socket_fits<socket_index>(socket))
+            return { index.end(), index.end() };
+
+        return index.equal_range(boost::make_tuple(node, socket));
+    }
+
     std::size_t output_degree(node_iterator iter) const {
         return output_degree(*iter);
     }
@@ -253,11 +387,172 @@ public:
         return input_degree(node) + output_degree(node);
     }
 
+    // Column holding the named attribute for every node, created on first
+    // use with every entry set to initial. Columns are separate from
+    // per-node attributes of the same name. Throws std::invalid_argument if
+    // the column exists with another type.
+    template <typename T>
+    attribute_column<T>& column(attribute_key const& name,
+                                T const& initial = T()) {
+        return make_column(columns_, name, nodes_.size(), initial);
+    }
+
+    // Existing column, or nullptr if there is none or its type differs.
+    template <typename T>
+    attribute_column<T> const* find_column(attribute_key const& name) const {
+        return find_column<T>(columns_, name);
+    }
+
+    void drop_column(attribute_key const& name) {
+        drop_column(columns_, name);
+    }
+
+    // Same as above, for columns holding an attribute of every link.
+    template <typename T>
+    attribute_column<T>& link_column(attribute_key const& name,
+                                     T const& initial = T()) {
+        return make_column(link_columns_, name, link_index_.size(), initial);
+    }
+
+    template <typename T>
+    attribute_column<T> const* find_link_column(
+        attribute_key const& name) const {
+        return find_column<T>(link_columns_, name);
+    }
+
+    void drop_link_column(attribute_key const& name) {
+        drop_column(link_columns_, name);
+    }
+
 private:
-    std::set<graph_node*> nodes_;
+    friend class graph_builder;
+
+    void retire(graph_node* node);
+    void dispose(graph_node* node);
+    void release_arena();
+
+    void attach(graph_node* node) {
+        if (journal_) {
+            node->journal_ = journal_.get();
+            journal_->record(graph_event::node_added, node->handle());
+        }
+    }
+
+    void record(graph_event::kind_t kind) {
+        if (journal_)
+            journal_->record(kind);
+    }
+
+    void record(graph_event::kind_t kind, graph_link const& link) {
+        if (journal_)
+            journal_->record(kind, link);
+    }
+
+    // Give a newly inserted link the next index.
+    void attach(graph_link const& link) {
+        link.index_ = static_cast<std::uint32_t>(link_index_.size());
+        link_index_.push_back(&link);
+
+        for (auto& column : link_columns_)
+            column.second->resize(link_index_.size());
+    }
+
+    // Record the removal of a link about to be erased, and move the last
+    // link into its index.
+    void retire(graph_link const& link) {
+        record(graph_event::unlinked, link);
+
+        std::size_t index = link.index_;
+
+        if (index + 1 < link_index_.size()) {
+            link_index_[index] = link_index_.back();
+            link_index_[index]->index_ = link.index_;
+        }
+
+        link_index_.pop_back();
+
+        for (auto& column : link_columns_)
+            column.second->erase(index);
+    }
+
+    template <typename Iterator>
+    void retire(std::pair<Iterator, Iterator> const& range) {
+        for (auto it = range.first; it != range.second; ++it)
+            retire(*it);
+    }
+
+    void grow_columns() {
+        for (auto& column : columns_)
+            column.second->resize(nodes_.size());
+    }
+
+    using column_list = std::vector<
+        std::pair<attribute_key, std::unique_ptr<detail::column_base>>>;
+
+    template <typename T>
+    static attribute_column<T>& make_column(column_list& columns,
+                                            attribute_key const& name,
+                                            std::size_t size,
+                                            T const& initial);
+
+    template <typename T>
+    static attribute_column<T> const* find_column(column_list const& columns,
+                                                  attribute_key const& name);
+
+    static void drop_column(column_list& columns, attribute_key const& name);
+
+    static void copy_columns(column_list& to, column_list const& from);
+
+    std::unique_ptr<arena> arena_;
+    // Nodes moved by compact() when there is no arena.
+    std::unique_ptr<arena> block_;
+    std::unique_ptr<graph_journal> journal_;
+
+    detail::node_list nodes_;
     detail::link_list links_;
+
+    // Stored links by index.
+    std::vector<graph_link const*> link_index_;
+
+    column_list columns_;
+    column_list link_columns_;
 };
 
+template <typename T>
+attribute_column<T>& graph::make_column(column_list& columns,
+                                        attribute_key const& name,
+                                        std::size_t size,
+                                        T const& initial) {
+    for (auto& column : columns) {
+        if (column.first == name) {
+            auto typed =
+                dynamic_cast<attribute_column<T>*>(column.second.get());
+
+            if (!typed)
+                throw std::invalid_argument("Column type mismatch");
+
+            return *typed;
+        }
+    }
+
+    auto typed = new attribute_column<T>(size, initial);
+    columns.emplace_back(name, std::unique_ptr<detail::column_base>(typed));
+
+    return *typed;
+}
+
+template <typename T>
+attribute_column<T> const* graph::find_column(column_list const& columns,
+                                              attribute_key const& name) {
+    for (auto const& column : columns) {
+        if (column.first == name)
+            return dynamic_cast<attribute_column<T> const*>(
+                column.second.get());
+    }
+
+    return nullptr;
+}
+
 } /* namespace nodal */
 
 #include "detail/graph_access.hpp"
@@ -0,0 +1,104 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "frozen_graph.hpp"
+#include "graph.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace nodal
+{
+
+// Collects nodes and links into flat arrays and turns them into a graph in
+// one batch: sockets are validated once per node rather than once per link,
+// and the link indices are filled from sorted input.
+class graph_builder {
+public:
+    using node_id = std::uint32_t;
+
+    void reserve(std::size_t node_count, std::size_t link_count) {
+        nodes_.reserve(node_count);
+        links_.reserve(link_count);
+    }
+
+    void clear() {
+        nodes_.clear();
+        links_.clear();
+    }
+
+    node_id add(class node const* node);
+
+    // Set the definition of a node added earlier, typically as a null
+    // placeholder for a node that was referenced before being defined.
+    void assign(node_id id, class node const* node) {
+        nodes_.at(id) = node;
+    }
+
+    void link(node_id source_node, std::size_t source_socket,
+              node_id target_node, std::size_t target_socket);
+
+    std::size_t node_count() const {
+        return nodes_.size();
+    }
+
+    std::size_t link_count() const {
+        return links_.size();
+    }
+
+    // Append the collected nodes and links to graph. Nodes are added in id
+    // order; the returned iterator points to the node built for id 0.
+    // The builder is left empty.
+    graph::node_iterator build(graph& graph);
+
+    // Build several builders into graph at once, typically after filling
+    // each on a different thread. Validation, node construction and link
+    // sorting run in parallel, one builder per thread; the graph's link
+    // indices are then filled in a single sequential pass. Links can only
+    // join nodes of the same builder. Returns, for each builder, the node
+    // built for its id 0, and leaves all builders empty.
+    static std::vector<graph::node_iterator>
+    build(graph& graph, std::vector<graph_builder*> const& builders);
+
+    // Same as build(), also returning a snapshot of the resulting graph.
+    // When graph starts out empty, the snapshot is produced from the
+    // builder's arrays without walking the graph's link indices.
+    frozen_graph freeze(graph& graph);
+
+private:
+    void validate() const;
+    graph::node_iterator insert(graph& graph);
+
+    std::vector<graph_link> sorted_links(graph::node_iterator gnodes) const;
+    static void insert_links(graph& graph,
+                             std::vector<graph_link> const& links);
+
+    std::vector<class node const*> nodes_;
+    std::vector<frozen_link> links_;
+};
+
+} /* namespace nodal */
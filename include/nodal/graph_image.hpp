@@ -0,0 +1,220 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "frozen_graph.hpp"
+#include "graph.hpp"
+#include "typed_node.hpp"
+
+#include "detail/image_format.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nodal
+{
+
+// Read-only graph stored in a binary image file and mapped into memory.
+// The image holds the node table as type ids, the links in the same
+// compressed sparse row layout as frozen_graph, and a data block for each
+// node: its raw bytes when the data is raw-copyable (see is_raw_copyable),
+// or else the output of typed_node::serialize_data(). Sections are
+// addressed by file offsets only, so the image is usable as soon as it is
+// mapped: only the header and the section bounds are checked, the contents
+// are trusted.
+//
+// Type ids index a table of node definitions supplied by the caller, both
+// when writing and when loading the image.
+class graph_image {
+public:
+    using node_id = frozen_graph::node_id;
+    using link_id = frozen_graph::link_id;
+
+    static constexpr std::uint32_t version = detail::image_version;
+
+    static constexpr std::uint32_t npos = frozen_graph::npos;
+
+    using node_iterator = frozen_graph::node_iterator;
+    using node_range    = frozen_graph::node_range;
+
+    using link_iterator = frozen_graph::link_iterator;
+    using link_range    = frozen_graph::link_range;
+
+    using input_link_iterator = frozen_graph::input_link_iterator;
+    using input_link_range    = frozen_graph::input_link_range;
+
+    using output_link_iterator = frozen_graph::output_link_iterator;
+    using output_link_range    = frozen_graph::output_link_range;
+
+    // Write graph to the file at path. Each node's type id is the position
+    // of its definition in types. Throws std::logic_error if node data
+    // that is not raw-copyable holds a value its type cannot serialize.
+    static void write(std::string const& path, graph const& graph,
+                      std::vector<class node const*> const& types);
+
+    graph_image() = default;
+    explicit graph_image(std::string const& path);
+
+    graph_image(graph_image&& other);
+    graph_image& operator=(graph_image&& other);
+
+    ~graph_image();
+
+    bool empty() const {
+        return !header_;
+    }
+
+    node_iterator nodes_begin() const {
+        return node_iterator(0);
+    }
+
+    node_iterator nodes_end() const {
+        return node_iterator(node_id(node_count()));
+    }
+
+    node_range nodes() const {
+        return { nodes_begin(), nodes_end() };
+    }
+
+    std::size_t node_count() const {
+        return node_count_;
+    }
+
+    std::uint32_t type_id(node_id node) const {
+        return types_[node];
+    }
+
+    // Data block of the node, or an empty block if none was stored.
+    std::pair<void const*, std::size_t> data(node_id node) const {
+        return { data_ + data_offsets_[node],
+                 data_sizes_[node] & ~detail::image_serialized_flag };
+    }
+
+    // Whether the node's data block was written by serialize_data() rather
+    // than copied bytewise.
+    bool data_serialized(node_id node) const {
+        return (data_sizes_[node] & detail::image_serialized_flag) != 0;
+    }
+
+    frozen_link const& link(link_id id) const {
+        return links_[id];
+    }
+
+    link_iterator links_begin() const {
+        return link_iterator(0);
+    }
+
+    link_iterator links_end() const {
+        return link_iterator(link_id(link_count()));
+    }
+
+    link_range links() const {
+        return { links_begin(), links_end() };
+    }
+
+    std::size_t link_count() const {
+        return link_count_;
+    }
+
+    input_link_range input_links(node_id node) const {
+        return { input_index_ + input_offsets_[node],
+                 input_index_ + input_offsets_[node + 1] };
+    }
+
+    input_link_range input_links(node_id node, std::uint32_t socket) const;
+
+    std::size_t input_degree(node_id node) const {
+        return input_offsets_[node + 1] - input_offsets_[node];
+    }
+
+    output_link_range output_links(node_id node) const {
+        return { link_iterator(output_offsets_[node]),
+                 link_iterator(output_offsets_[node + 1]) };
+    }
+
+    output_link_range output_links(node_id node, std::uint32_t socket) const;
+
+    std::size_t output_degree(node_id node) const {
+        return output_offsets_[node + 1] - output_offsets_[node];
+    }
+
+    // Append the image's nodes and links to graph through graph_builder,
+    // resolving type ids through types, then copy the stored data blocks
+    // into the new nodes. Returns the node built for id 0. Type ids and data
+    // blocks are checked before anything is added, so if they do not match
+    // types, load() throws and leaves graph unchanged.
+    graph::node_iterator load(graph& graph,
+                              std::vector<class node const*> const& types)
+        const;
+
+private:
+    void swap(graph_image& other);
+    void unmap();
+
+    detail::image_header const* header_ = nullptr;
+    std::size_t size_ = 0;
+
+    std::size_t node_count_ = 0;
+    std::size_t link_count_ = 0;
+
+    std::uint32_t const* types_ = nullptr;
+    std::uint32_t const* output_offsets_ = nullptr;
+    frozen_link const* links_ = nullptr;
+    std::uint32_t const* input_offsets_ = nullptr;
+    link_id const* input_index_ = nullptr;
+    std::uint64_t const* data_offsets_ = nullptr;
+    std::uint32_t const* data_sizes_ = nullptr;
+    unsigned char const* data_ = nullptr;
+};
+
+// A graph image together with the mutable graph built from it. Reads go
+// to the mapped image until the first call to edit(), which loads the
+// graph; later edits are not written back to the image.
+class mapped_graph {
+public:
+    mapped_graph(std::string const& path,
+                 std::vector<class node const*> types);
+
+    graph_image const& image() const {
+        return image_;
+    }
+
+    bool materialized() const {
+        return graph_ != nullptr;
+    }
+
+    graph& edit();
+
+private:
+    graph_image image_;
+    std::vector<class node const*> types_;
+    std::unique_ptr<graph> graph_;
+};
+
+} /* namespace nodal */
@@ -0,0 +1,118 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "graph_image.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    class image_spool;
+
+} /* namespace detail */
+
+// Writes a graph image without building a graph first, for graphs larger
+// than memory. Nodes and links are added as with graph_builder; links and
+// data blocks go to temporary files next to the image, and finish() sorts
+// the links in passes over those files, holding at most memory_size bytes
+// of links at a time. Beyond that, memory use is about 32 bytes per node.
+// graph_importer can feed a writer directly.
+//
+// Loading the image gives the same graph as loading one written by
+// graph_image::write() from the graph the nodes and links describe.
+class graph_image_writer {
+public:
+    using node_id = graph_image::node_id;
+
+    static constexpr std::size_t default_memory_size = std::size_t(64) << 20;
+
+    // Type ids index types, as for graph_image::write().
+    graph_image_writer(std::string path, std::vector<class node const*> types,
+                       std::size_t memory_size = default_memory_size);
+    ~graph_image_writer();
+
+    graph_image_writer(graph_image_writer const&) = delete;
+    graph_image_writer& operator=(graph_image_writer const&) = delete;
+
+    // Add a node with data as its data block, or a null placeholder to
+    // assign() later. Nodes stored without data get their type's default
+    // data when the image is loaded. Throws std::invalid_argument if the
+    // node is not in the type table, and std::logic_error like
+    // graph_image::write() if the data cannot be stored.
+    node_id add(class node const* node, node_data const* data = nullptr);
+
+    void assign(node_id id, class node const* node,
+                node_data const* data = nullptr);
+
+    // Throws std::out_of_range unless both nodes were added.
+    void link(node_id source_node, std::size_t source_socket,
+              node_id target_node, std::size_t target_socket);
+
+    std::size_t node_count() const {
+        return node_types.size();
+    }
+
+    // Links added so far, duplicates included.
+    std::size_t link_count() const {
+        return spooled_links;
+    }
+
+    // Check the nodes and links and write the image. Throws
+    // std::invalid_argument if a placeholder was never assigned and
+    // std::out_of_range if a socket is out of range; the image file is
+    // only created once every link has been checked. Call it once: the
+    // writer cannot be used afterwards.
+    void finish();
+
+private:
+    void store(node_id id, class node const* node, node_data const* data);
+    void check_open() const;
+
+    std::string path;
+    std::vector<class node const*> types;
+    std::unordered_map<class node const*, std::uint32_t> type_ids;
+    std::size_t memory_size;
+
+    std::vector<std::uint32_t> node_types;
+    std::vector<std::uint32_t> output_degrees;
+    std::vector<std::uint64_t> data_offsets;
+    std::vector<std::uint32_t> data_sizes;
+    std::vector<std::uint8_t> block;
+
+    std::unique_ptr<detail::image_spool> link_spool;
+    std::unique_ptr<detail::image_spool> data_spool;
+    std::size_t spooled_links = 0;
+};
+
+} /* namespace nodal */
@@ -0,0 +1,141 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "graph.hpp"
+#include "graph_builder.hpp"
+#include "graph_image_writer.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nodal
+{
+
+// Streaming parser for textual graph descriptions. Input is consumed in
+// chunks and fed straight into a graph_builder, or a graph_image_writer,
+// so only the current line is ever buffered. Two formats are understood,
+// one record per line:
+//
+//   lines:       node <id> <type>
+//                link <id> <socket> <id> <socket>
+//
+//   json_lines:  {"node": <id>, "type": "<type>"}
+//                {"source": <id>, "source_socket": <n>,
+//                 "target": <id>, "target_socket": <n>}
+//
+// Blank lines and, in the line format, lines starting with '#' are
+// skipped; unknown JSON members are ignored. Ids are strings or unsigned
+// integers and may be referenced before the node is defined. Integer ids
+// are resolved through a flat table, which only grows while ids stay below
+// twice the number of nodes seen so far; larger integer ids and names go
+// to hash tables. Type names are resolved through the table given to the
+// constructor.
+class graph_importer {
+public:
+    using node_id = graph_builder::node_id;
+
+    enum format_t {
+        lines,
+        json_lines
+    };
+
+    graph_importer(format_t format,
+                   std::unordered_map<std::string, class node const*> types);
+
+    // Import into writer instead, so that links go to its spool file as
+    // they are parsed and are never held in memory. Call write() instead
+    // of build().
+    graph_importer(format_t format,
+                   std::unordered_map<std::string, class node const*> types,
+                   graph_image_writer& writer);
+
+    // Parse the next chunk of input. Records may span chunk boundaries.
+    void feed(char const* data, std::size_t size);
+
+    // Parse everything that can be read from fd, then call finish().
+    void read(int fd);
+
+    // Parse a final record not terminated by a newline.
+    void finish();
+
+    std::size_t node_count() const {
+        return writer ? writer->node_count() : builder.node_count();
+    }
+
+    std::size_t link_count() const {
+        return writer ? writer->link_count() : builder.link_count();
+    }
+
+    // Builder id of the node with the given id, or frozen_graph::npos.
+    node_id find(std::string const& id) const;
+
+    // Append the imported nodes and links to graph, in builder id order,
+    // and reset the importer. Throws std::invalid_argument if a referenced
+    // node was never defined.
+    graph::node_iterator build(graph& graph);
+
+    // Same as build(), finishing the image of the writer given to the
+    // constructor.
+    void write();
+
+private:
+    void parse_line(char const* first, char const* last);
+    void parse_record(char const* first, char const* last);
+    void parse_json(char const* first, char const* last);
+
+    void define(char const* first, char const* last,
+                std::string const& type);
+    void link(node_id source, std::uint64_t source_socket,
+              node_id target, std::uint64_t target_socket);
+
+    void check_defined() const;
+    void reset();
+
+    node_id resolve(char const* first, char const* last);
+    node_id& integer_slot(std::uint64_t id);
+
+    std::invalid_argument error(std::string const& what) const;
+
+    format_t format;
+    std::unordered_map<std::string, class node const*> types;
+
+    graph_builder builder;
+    graph_image_writer* writer = nullptr;
+    std::vector<bool> defined;
+
+    std::vector<node_id> dense_ids;
+    std::unordered_map<std::uint64_t, node_id> sparse_ids;
+    std::unordered_map<std::string, node_id> named_ids;
+
+    std::string partial;
+    std::size_t line = 0;
+};
+
+} /* namespace nodal */
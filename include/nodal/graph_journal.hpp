@@ -0,0 +1,136 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "graph_link.hpp"
+#include "graph_node.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace nodal
+{
+
+struct graph_event {
+    enum kind_t : std::uint8_t {
+        node_added,
+        node_removed,
+        linked,
+        unlinked,
+        attribute_changed,
+        data_changed,
+        links_cleared,
+        cleared
+    };
+
+    kind_t kind;
+
+    // Link events only.
+    std::uint32_t source_socket;
+    std::uint32_t target_socket;
+
+    // The node for node events, the source node for link events.
+    node_handle node;
+
+    // The target node for link events.
+    node_handle target;
+};
+
+// Fixed-size ring buffer of graph mutations. Every event gets a sequence
+// number; a consumer keeps a cursor holding the next sequence number it
+// wants to see and reads the events recorded since. When a consumer falls
+// more than capacity() events behind, the events it missed are lost and it
+// has to rescan the graph.
+//
+// Attribute and data events are recorded on non-const access, whether or
+// not the value is actually modified.
+class graph_journal {
+public:
+    using sequence = std::uint64_t;
+
+    static constexpr std::size_t default_capacity = 4096;
+
+    struct cursor {
+        sequence position;
+    };
+
+    explicit graph_journal(std::size_t capacity = default_capacity);
+
+    std::size_t capacity() const {
+        return events.size();
+    }
+
+    // Sequence number of the next event to be recorded.
+    sequence head() const {
+        return head_;
+    }
+
+    // Sequence number of the oldest event still available.
+    sequence tail() const {
+        return head_ > events.size() ? head_ - events.size() : 0;
+    }
+
+    // A cursor positioned after all events recorded so far.
+    cursor sync() const {
+        return { head_ };
+    }
+
+    // Also true for cursors that do not belong to this journal's history.
+    bool lost(cursor const& c) const {
+        return c.position < tail() || c.position > head_;
+    }
+
+    // Call fn for every event recorded since c, and advance c to head().
+    // Returns false without calling fn if some of those events were lost.
+    template <typename Fn>
+    bool read(cursor& c, Fn&& fn) const {
+        if (lost(c))
+            return false;
+
+        for (; c.position != head_; ++c.position)
+            fn(events[c.position & mask]);
+
+        return true;
+    }
+
+    void record(graph_event::kind_t kind, node_handle node = {}) {
+        events[head_++ & mask] = { kind, 0, 0, node, {} };
+    }
+
+    void record(graph_event::kind_t kind, graph_link const& link) {
+        events[head_++ & mask] = { kind,
+                                   std::uint32_t(link.source_socket),
+                                   std::uint32_t(link.target_socket),
+                                   link.source_node->handle(),
+                                   link.target_node->handle() };
+    }
+
+private:
+    std::vector<graph_event> events;
+    std::size_t mask;
+    sequence head_ = 0;
+};
+
+} /* namespace nodal */
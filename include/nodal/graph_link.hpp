@@ -27,10 +27,44 @@
 #include "graph_node.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 
 namespace nodal
 {
 
+// Storage type of link socket indices. Building with NODAL_COMPACT_LINKS
+// narrows it to 16 bits, which shrinks both graph_link and frozen_link but
+// limits links to the first 65535 sockets of each node; constructing a link
+// to a later socket throws std::out_of_range.
+#ifdef NODAL_COMPACT_LINKS
+using socket_index = std::uint16_t;
+#else
+using socket_index = std::size_t;
+#endif
+
+namespace detail
+{
+
+    // Whether a socket index fits in the storage type Socket.
+    template <typename Socket>
+    bool socket_fits(std::size_t socket) {
+        return socket <= std::size_t(std::numeric_limits<Socket>::max());
+    }
+
+    // Narrows a socket index to its storage type, throwing
+    // std::out_of_range rather than wrapping.
+    template <typename Socket>
+    Socket narrow_socket(std::size_t socket) {
+        if (!socket_fits<Socket>(socket))
+            throw std::out_of_range("Socket index too large for link");
+
+        return Socket(socket);
+    }
+
+} /* namespace detail */
+
 class graph_link {
 public:
     struct hash {
@@ -41,20 +75,35 @@ public:
 
     graph_link(graph_node* source_node, std::size_t source_socket,
                graph_node* target_node, std::size_t target_socket)
-        : source_node(source_node), source_socket(source_socket),
-          target_node(target_node), target_socket(target_socket)
+        : source_node(source_node), target_node(target_node),
+          source_socket(detail::narrow_socket<socket_index>(source_socket)),
+          target_socket(detail::narrow_socket<socket_index>(target_socket))
         {}
 
+    // Pointers first, so that narrow sockets pack with the index.
     graph_node* source_node;
-    std::size_t source_socket;
-
     graph_node* target_node;
-    std::size_t target_socket;
+
+    socket_index source_socket;
+    socket_index target_socket;
+
+    // Dense position of the link in its graph, in [0, link_count()), or
+    // node_handle::npos for links not taken from a graph. Removing other
+    // links may change it, leaving older copies stale.
+    std::size_t index() const {
+        return index_;
+    }
 
     bool operator==(graph_link const& other) const;
     bool operator!=(graph_link const& other) const {
         return !(*this == other);
     }
+
+private:
+    friend class graph;
+
+    // Not part of the link's key, so the graph may update it in place.
+    mutable std::uint32_t index_ = node_handle::npos;
 };
 
 } /* namespace nodal */
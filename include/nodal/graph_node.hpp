@@ -28,14 +28,49 @@
 #include "node.hpp"
 #include "node_data.hpp"
 
+#include <cstdint>
+#include <limits>
+
 namespace nodal
 {
 
+class graph;
+class graph_journal;
+
+namespace detail
+{
+
+    class node_list;
+
+} /* namespace detail */
+
+struct node_handle {
+    static constexpr std::uint32_t npos =
+        std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t id = npos;
+    std::uint32_t generation = 0;
+
+    bool operator==(node_handle const& other) const {
+        return id == other.id && generation == other.generation;
+    }
+
+    bool operator!=(node_handle const& other) const {
+        return !(*this == other);
+    }
+};
+
+// Copies of a graph_node share its node data and attributes. Shared state
+// is duplicated the first time it is accessed through a non-const path, so
+// copying a graph and reading it costs no clone() calls. Nodes allocated in
+// an arena never share their state, since the arena may be released first.
 class graph_node {
 public:
     graph_node(class node const* node);
+    graph_node(class node const* node, arena* arena);
 
     graph_node(graph_node const& other);
+    graph_node(graph_node const& other, arena* arena);
     graph_node(graph_node&& other);
 
     ~graph_node();
@@ -47,7 +82,25 @@ public:
         return node_;
     }
 
+    // Dense position of the node in its graph, in [0, node_count()).
+    // Removing other nodes may change it.
+    std::size_t index() const {
+        return index_;
+    }
+
+    // Stable identifier of the node in its graph. Remains valid until the
+    // node is removed; later lookups of the same handle then fail.
+    node_handle handle() const {
+        return handle_;
+    }
+
     node_data* data() {
+        if (data_ && data_->ref_count.load(std::memory_order_acquire) > 1)
+            detach_data();
+
+        if (journal_)
+            record_data_write();
+
         return data_;
     }
 
@@ -55,22 +108,46 @@ public:
         return data_;
     }
 
+    // Replace the node's data with a copy of data, or drop it if null.
+    void set_data(node_data const* data);
+
     attribute_value& attribute(attribute_key const& key) {
-        return attributes[key];
+        return writable_attributes()[key];
     }
 
-    attribute_value const& attribute(attribute_key const& key) const {
-        return attributes.at(key);
-    }
+    attribute_value const& attribute(attribute_key const& key) const;
 
-    bool has_attribute(attribute_key const& key) const {
-        return attributes.count(key);
-    }
+    bool has_attribute(attribute_key const& key) const;
 
 private:
+    friend class graph;
+    friend class detail::node_list;
+
+    struct attribute_block;
+
+    static node_data* acquire(node_data* data);
+    static attribute_block* acquire(attribute_block* attributes);
+
+    static void release(node_data* data);
+    static void release(attribute_block* attributes);
+
+    static attribute_block* make_attributes(attribute_map const* map,
+                                            arena* arena);
+
+    void detach_data();
+    void record_data_write();
+    attribute_map& writable_attributes();
+
     class node const* node_;
     node_data* data_;
-    attribute_map attributes;
+    attribute_block* attributes;
+    arena* arena_;
+    graph_journal* journal_ = nullptr;
+
+    std::uint32_t index_ = node_handle::npos;
+    node_handle handle_;
 };
 
 } /* namespace nodal */
+
+#include "detail/node_list.hpp"
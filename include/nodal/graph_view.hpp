@@ -0,0 +1,257 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "graph.hpp"
+
+#include <boost/dynamic_bitset.hpp>
+#include <boost/iterator/filter_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace nodal
+{
+
+// Read-only view of part of a graph. The view holds a list of the nodes it
+// includes and refers to the base graph for everything else; links are
+// visible when both their ends are in the view and they pass the optional
+// link filter. Nodes get dense ids in [0, node_count()), which serve as
+// vertex indices, so algorithms run on a view allocate and work in
+// proportion to the view rather than to the base graph.
+//
+// Changing the base graph invalidates the view.
+class graph_view {
+    struct input_filter {
+        bool operator()(graph_link const& link) const {
+            return view->contains(link.source_node) && view->accepts(link);
+        }
+
+        graph_view const* view = nullptr;
+    };
+
+    struct output_filter {
+        bool operator()(graph_link const& link) const {
+            return view->contains(link.target_node) && view->accepts(link);
+        }
+
+        graph_view const* view = nullptr;
+    };
+
+public:
+    using node_id = std::uint32_t;
+
+    static constexpr std::uint32_t npos =
+        std::numeric_limits<std::uint32_t>::max();
+
+    using node_filter = std::function<bool(graph_node const*)>;
+    using link_filter = std::function<bool(graph_link const&)>;
+
+    using node_iterator = std::vector<graph_node*>::const_iterator;
+    using node_range    = std::pair<node_iterator, node_iterator>;
+
+    class link_iterator;
+    using link_range = std::pair<link_iterator, link_iterator>;
+
+    using input_link_iterator =
+        boost::filter_iterator<input_filter, graph::input_link_iterator>;
+    using input_link_range =
+        std::pair<input_link_iterator, input_link_iterator>;
+
+    using output_link_iterator =
+        boost::filter_iterator<output_filter, graph::output_link_iterator>;
+    using output_link_range =
+        std::pair<output_link_iterator, output_link_iterator>;
+
+    // View of the given nodes, in the given order. Duplicates are ignored.
+    graph_view(graph const& graph, std::vector<graph_node*> nodes,
+               link_filter links = link_filter());
+
+    // View of the nodes whose index is set in mask.
+    graph_view(graph const& graph, boost::dynamic_bitset<> const& mask,
+               link_filter links = link_filter());
+
+    // View of the nodes accepted by a predicate. Scans the whole graph.
+    graph_view(graph const& graph, node_filter nodes,
+               link_filter links = link_filter());
+
+    graph const& base() const {
+        return *graph_;
+    }
+
+    bool contains(graph_node const* node) const {
+        return ids_.count(node) != 0;
+    }
+
+    bool contains(graph_link const& link) const {
+        return contains(link.source_node) && contains(link.target_node) &&
+               accepts(link);
+    }
+
+    // Dense id of a node in the view, or npos if it is not included.
+    node_id id(graph_node const* node) const {
+        auto it = ids_.find(node);
+        return (it != ids_.end()) ? it->second : npos;
+    }
+
+    graph_node* node(node_id id) const {
+        return nodes_[id];
+    }
+
+    node_iterator nodes_begin() const {
+        return nodes_.cbegin();
+    }
+
+    node_iterator nodes_end() const {
+        return nodes_.cend();
+    }
+
+    node_range nodes() const {
+        return { nodes_.cbegin(), nodes_.cend() };
+    }
+
+    std::size_t node_count() const {
+        return nodes_.size();
+    }
+
+    link_iterator links_begin() const;
+    link_iterator links_end() const;
+    link_range links() const;
+
+    // Counts the links on every call.
+    std::size_t link_count() const;
+
+    input_link_range input_links(graph_node* node) const {
+        auto range = graph_->input_links(node);
+        input_filter filter { this };
+
+        return { input_link_iterator(filter, range.first, range.second),
+                 input_link_iterator(filter, range.second, range.second) };
+    }
+
+    std::size_t input_degree(graph_node* node) const {
+        auto range = input_links(node);
+        return std::distance(range.first, range.second);
+    }
+
+    output_link_range output_links(graph_node* node) const {
+        auto range = graph_->output_links(node);
+        output_filter filter { this };
+
+        return { output_link_iterator(filter, range.first, range.second),
+                 output_link_iterator(filter, range.second, range.second) };
+    }
+
+    std::size_t output_degree(graph_node* node) const {
+        auto range = output_links(node);
+        return std::distance(range.first, range.second);
+    }
+
+    std::size_t degree(graph_node* node) const {
+        return input_degree(node) + output_degree(node);
+    }
+
+private:
+    void insert(graph_node* node) {
+        if (ids_.emplace(node, node_id(nodes_.size())).second)
+            nodes_.push_back(node);
+    }
+
+    bool accepts(graph_link const& link) const {
+        return !link_filter_ || link_filter_(link);
+    }
+
+    graph const* graph_;
+    link_filter link_filter_;
+
+    std::vector<graph_node*> nodes_;
+    std::unordered_map<graph_node const*, node_id> ids_;
+};
+
+// Iterates over the output links of each node in the view in turn.
+class graph_view::link_iterator
+    : public boost::iterator_facade<link_iterator, graph_link const,
+                                    boost::forward_traversal_tag> {
+public:
+    link_iterator() = default;
+
+private:
+    friend class graph_view;
+    friend class boost::iterator_core_access;
+
+    link_iterator(graph_view const* view, std::size_t node)
+        : view(view), node(node)
+    {
+        if (node < view->nodes_.size()) {
+            std::tie(it, end) = view->output_links(view->nodes_[node]);
+            settle();
+        }
+    }
+
+    void settle() {
+        while (it == end && ++node < view->nodes_.size())
+            std::tie(it, end) = view->output_links(view->nodes_[node]);
+    }
+
+    void increment() {
+        ++it;
+        settle();
+    }
+
+    bool equal(link_iterator const& other) const {
+        return node == other.node &&
+               (node >= view->nodes_.size() || it == other.it);
+    }
+
+    graph_link const& dereference() const {
+        return *it;
+    }
+
+    graph_view const* view = nullptr;
+    std::size_t node = 0;
+    output_link_iterator it, end;
+};
+
+inline graph_view::link_iterator graph_view::links_begin() const {
+    return link_iterator(this, 0);
+}
+
+inline graph_view::link_iterator graph_view::links_end() const {
+    return link_iterator(this, nodes_.size());
+}
+
+inline graph_view::link_range graph_view::links() const {
+    return { links_begin(), links_end() };
+}
+
+} /* namespace nodal */
+
+#include "detail/graph_view_access.hpp"
+#include "detail/graph_view_properties.hpp"
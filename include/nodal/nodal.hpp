@@ -31,11 +31,26 @@
 #include "types.hpp"
 #include "typed_node.hpp"
 
+#include "diff.hpp"
+#include "fingerprint.hpp"
+#include "frozen_graph.hpp"
 #include "graph.hpp"
+#include "graph_builder.hpp"
+#include "graph_image.hpp"
+#include "graph_image_writer.hpp"
+#include "graph_importer.hpp"
+#include "graph_view.hpp"
+#include "node_order.hpp"
+#include "paged_graph.hpp"
+#include "subgraph_node.hpp"
+#include "versioned_graph.hpp"
 
 #include "compiler.hpp"
 
 #include "passes/cycle_detection.hpp"
 #include "passes/dead_branch_removal.hpp"
 #include "passes/depth_first_search.hpp"
+#include "passes/flatten.hpp"
+#include "passes/partition.hpp"
+#include "passes/subgraph_compilation.hpp"
 #include "passes/topological_sort.hpp"
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -34,10 +35,38 @@ namespace nodal
 
 class node_data {
 public:
+    node_data() = default;
+
+    // The reference count belongs to the object, not to its value.
+    node_data(node_data const&) {}
+
+    node_data& operator=(node_data const&) {
+        return *this;
+    }
+
     virtual ~node_data() {}
 
+    // Node data is placed in the arena of the innermost active arena::scope
+    // on the current thread, if any, and on the heap otherwise.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr);
+
     virtual node_data* clone() const = 0;
 
+    // Size of the data as a block of raw bytes, or 0 if it cannot be stored
+    // bytewise. See is_raw_copyable.
+    virtual std::size_t raw_size() const {
+        return 0;
+    }
+
+    void* raw_data() {
+        return data_ptr(raw_size());
+    }
+
+    void const* raw_data() const {
+        return data_ptr(raw_size());
+    }
+
     template <typename T>
     T& data() {
         return *reinterpret_cast<T*>(data_ptr(sizeof(T)));
@@ -69,10 +98,15 @@ public:
     }
 
 private:
+    friend class graph_node;
+
     virtual void* data_ptr(std::size_t size) const;
 
     virtual void* input_ptr(std::size_t index, std::size_t size) const;
     virtual void* param_ptr(std::size_t index, std::size_t size) const;
+
+    // Number of graph nodes sharing this object.
+    mutable std::atomic<std::size_t> ref_count { 0 };
 };
 
 template <typename S, typename T, T S::*Member>
@@ -106,9 +140,31 @@ struct data_block<> {};
 
 using no_data_block = data_block<>;
 
+// Whether struct node data of type T is stored as its raw bytes in graph
+// images and patches. Arithmetic and enum types and arrays of them are.
+// Classes are not by default, since a trivially copyable struct may still
+// hold pointers that would be meaningless once reloaded: their data goes
+// through typed_node::serialize_data(), which stores only the declared
+// input and parameter fields and, like type::serialize(), throws
+// std::logic_error for pointers. Specialise this to std::true_type for a
+// trivially copyable struct of plain values to store it bytewise.
+template <typename T>
+struct is_raw_copyable
+    : std::integral_constant<
+          bool, std::is_arithmetic<std::remove_all_extents_t<T>>::value ||
+                    std::is_enum<std::remove_all_extents_t<T>>::value> {};
+
 namespace detail
 {
 
+    template <typename T>
+    constexpr std::size_t raw_size_of() {
+        static_assert(!is_raw_copyable<T>::value ||
+                          std::is_trivially_copyable<T>::value,
+                      "Raw-copyable data must be trivially copyable");
+        return is_raw_copyable<T>::value ? sizeof(T) : 0;
+    }
+
     template <typename T, typename InputBlock, typename ParamBlock>
     class struct_node_data_impl : public node_data {
     public:
@@ -121,6 +177,10 @@ namespace detail
             return new struct_node_data_impl(data);
         }
 
+        std::size_t raw_size() const override {
+            return raw_size_of<T>();
+        }
+
         T data;
 
     private:
@@ -164,6 +224,10 @@ namespace detail
             return new struct_node_data_impl(data);
         }
 
+        std::size_t raw_size() const override {
+            return raw_size_of<T>();
+        }
+
         T data;
 
     private:
@@ -198,6 +262,10 @@ namespace detail
             return new struct_node_data_impl(data);
         }
 
+        std::size_t raw_size() const override {
+            return raw_size_of<T>();
+        }
+
         T data;
 
     private:
@@ -232,6 +300,10 @@ namespace detail
             return new struct_node_data_impl(data);
         }
 
+        std::size_t raw_size() const override {
+            return raw_size_of<T>();
+        }
+
         T data;
 
     private:
@@ -0,0 +1,51 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "graph.hpp"
+
+#include <vector>
+
+namespace nodal
+{
+
+// Node orders for graph::compact(). Each returns every node of the graph
+// exactly once; ties are broken by current index, so the orders are
+// deterministic.
+
+// Sources first, each node after all of its inputs. Nodes on cycles, which
+// have no such position, follow in index order.
+std::vector<graph_node*> topological_order(graph const& graph);
+
+// Breadth-first along output links, starting from the nodes without inputs
+// and then from any node not reached yet.
+std::vector<graph_node*> breadth_first_order(graph const& graph);
+
+// Reverse Cuthill-McKee ordering over links taken in both directions,
+// which keeps the index distance between linked nodes small. Each
+// connected component starts from one of its nodes of lowest degree.
+std::vector<graph_node*> reverse_cuthill_mckee_order(graph const& graph);
+
+} /* namespace nodal */
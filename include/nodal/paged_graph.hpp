@@ -0,0 +1,222 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "graph_image.hpp"
+
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    class page_cache;
+
+} /* namespace detail */
+
+// Disk-backed, read-only graph over a graph image file, for graphs larger
+// than memory. The image is read on demand in fixed-size pages through an
+// LRU cache, so resident memory stays within the cache size plus whatever
+// per-node state the caller keeps, such as a colour map. Images of graphs
+// that do not fit in memory either are written with graph_image_writer.
+//
+// Sections are laid out in node id order, so traversals that visit nodes
+// in that order read pages sequentially. Compacting a graph into
+// topological or breadth-first order (see node_order.hpp) before writing
+// its image makes those traversals sequential.
+//
+// Links and ids are returned by value, since any access may evict a page.
+// The cache is shared by all accessors: a paged_graph must not be used by
+// several threads at once.
+class paged_graph {
+public:
+    using node_id = graph_image::node_id;
+    using link_id = graph_image::link_id;
+
+    static constexpr std::uint32_t npos = graph_image::npos;
+
+    static constexpr std::size_t default_page_size = 1 << 16;
+    static constexpr std::size_t default_cache_size = std::size_t(64) << 20;
+
+    using node_iterator = graph_image::node_iterator;
+    using node_range    = graph_image::node_range;
+
+    using link_iterator = graph_image::link_iterator;
+    using link_range    = graph_image::link_range;
+
+    struct input_index_reader {
+        paged_graph const* graph;
+
+        link_id operator()(std::uint32_t position) const {
+            return graph->input_index(position);
+        }
+    };
+
+    using input_link_iterator =
+        boost::transform_iterator<input_index_reader,
+                                  boost::counting_iterator<std::uint32_t>,
+                                  link_id, link_id>;
+    using input_link_range =
+        std::pair<input_link_iterator, input_link_iterator>;
+
+    using output_link_iterator = link_iterator;
+    using output_link_range    = link_range;
+
+    explicit paged_graph(std::string const& path,
+                         std::size_t cache_size = default_cache_size,
+                         std::size_t page_size = default_page_size);
+
+    paged_graph(paged_graph&& other);
+    paged_graph& operator=(paged_graph&& other);
+
+    ~paged_graph();
+
+    node_iterator nodes_begin() const {
+        return node_iterator(0);
+    }
+
+    node_iterator nodes_end() const {
+        return node_iterator(node_id(node_count_));
+    }
+
+    node_range nodes() const {
+        return { nodes_begin(), nodes_end() };
+    }
+
+    std::size_t node_count() const {
+        return node_count_;
+    }
+
+    std::uint32_t type_id(node_id node) const {
+        return read<std::uint32_t>(types_, node);
+    }
+
+    // Copy of the node's data block; see graph_image::data().
+    std::vector<std::uint8_t> data(node_id node) const;
+
+    bool data_serialized(node_id node) const {
+        return (read<std::uint32_t>(data_sizes_, node) &
+                detail::image_serialized_flag) != 0;
+    }
+
+    frozen_link link(link_id id) const {
+        return read<frozen_link>(links_, id);
+    }
+
+    link_iterator links_begin() const {
+        return link_iterator(0);
+    }
+
+    link_iterator links_end() const {
+        return link_iterator(link_id(link_count_));
+    }
+
+    link_range links() const {
+        return { links_begin(), links_end() };
+    }
+
+    std::size_t link_count() const {
+        return link_count_;
+    }
+
+    input_link_range input_links(node_id node) const {
+        auto range = offsets(input_offsets_, node);
+
+        return { input_link_iterator(range.first, input_index_reader{ this }),
+                 input_link_iterator(range.second,
+                                     input_index_reader{ this }) };
+    }
+
+    std::size_t input_degree(node_id node) const {
+        auto range = offsets(input_offsets_, node);
+        return range.second - range.first;
+    }
+
+    output_link_range output_links(node_id node) const {
+        auto range = offsets(output_offsets_, node);
+        return { link_iterator(range.first), link_iterator(range.second) };
+    }
+
+    std::size_t output_degree(node_id node) const {
+        auto range = offsets(output_offsets_, node);
+        return range.second - range.first;
+    }
+
+    std::size_t degree(node_id node) const {
+        return input_degree(node) + output_degree(node);
+    }
+
+    // Bytes of the image currently held in the page cache.
+    std::size_t resident_size() const;
+
+private:
+    link_id input_index(std::uint32_t position) const {
+        return read<link_id>(input_index_, position);
+    }
+
+    std::pair<std::uint32_t, std::uint32_t>
+    offsets(std::uint64_t section, node_id node) const {
+        std::uint32_t range[2];
+        read(section + std::uint64_t(node) * 4, range, sizeof(range));
+        return { range[0], range[1] };
+    }
+
+    template <typename T>
+    T read(std::uint64_t section, std::uint64_t index) const {
+        T value;
+        read(section + index * sizeof(T), &value, sizeof(T));
+        return value;
+    }
+
+    void read(std::uint64_t offset, void* out, std::size_t size) const;
+
+    std::unique_ptr<detail::page_cache> cache_;
+
+    std::size_t node_count_ = 0;
+    std::size_t link_count_ = 0;
+
+    std::uint64_t types_ = 0;
+    std::uint64_t output_offsets_ = 0;
+    std::uint64_t links_ = 0;
+    std::uint64_t input_offsets_ = 0;
+    std::uint64_t input_index_ = 0;
+    std::uint64_t data_offsets_ = 0;
+    std::uint64_t data_sizes_ = 0;
+    std::uint64_t data_ = 0;
+};
+
+} /* namespace nodal */
+
+#include "detail/paged_graph_access.hpp"
+#include "detail/csr_graph_properties.hpp"
@@ -25,10 +25,15 @@
 #pragma once
 
 #include "../compiler.hpp"
+#include "../frozen_graph.hpp"
+#include "../graph_view.hpp"
+#include "../paged_graph.hpp"
 
 #include "../detail/unused.hpp"
+#include "../detail/vertex_scratch.hpp"
 
 #include <boost/graph/depth_first_search.hpp>
+#include <boost/graph/two_bit_color_map.hpp>
 
 namespace nodal
 {
@@ -48,6 +53,9 @@ public:
         {}
 
     any run(graph& graph, context& ctx) const override;
+    any run(frozen_graph const& graph, context& ctx) const;
+    any run(graph_view const& graph, context& ctx) const;
+    any run(paged_graph const& graph, context& ctx) const;
 
 private:
     Visitor visitor;
@@ -58,7 +66,48 @@ any depth_first_search_pass<Visitor>::run(graph& graph, context& ctx) const {
     Visitor v = visitor;
     v.context(ctx);
 
-    boost::depth_first_search(graph, v, boost::get(boost::vertex_color, graph));
+    detail::vertex_scratch<boost::default_color_type, nodal::graph> color(
+        graph);
+
+    boost::depth_first_search(graph, v, color.map());
+
+    return {};
+}
+
+template <typename Visitor>
+any depth_first_search_pass<Visitor>::run(frozen_graph const& graph,
+                                          context& ctx) const {
+    Visitor v = visitor;
+    v.context(ctx);
+
+    boost::depth_first_search(graph, boost::visitor(v));
+
+    return {};
+}
+
+template <typename Visitor>
+any depth_first_search_pass<Visitor>::run(graph_view const& graph,
+                                          context& ctx) const {
+    Visitor v = visitor;
+    v.context(ctx);
+
+    boost::depth_first_search(graph, boost::visitor(v));
+
+    return {};
+}
+
+template <typename Visitor>
+any depth_first_search_pass<Visitor>::run(paged_graph const& graph,
+                                          context& ctx) const {
+    Visitor v = visitor;
+    v.context(ctx);
+
+    // Two bits per node keep the only per-node state small.
+    boost::two_bit_color_map<
+        boost::property_map<paged_graph, boost::vertex_index_t>::const_type>
+        color(graph.node_count(), boost::get(boost::vertex_index, graph));
+
+    boost::depth_first_search(graph, boost::visitor(v).color_map(color));
 
     return {};
 }
@@ -0,0 +1,74 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "../compiler.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace nodal
+{
+
+struct partition_stats {
+    // Summed node cost of each part.
+    std::vector<double> part_costs;
+
+    // Links whose source and target are in different parts.
+    std::size_t cut_links = 0;
+
+    // Cost of the heaviest part over the average part cost.
+    double imbalance = 0;
+};
+
+// Assign every node to one of a number of parts, keeping the summed node
+// cost of each part within tolerance times the average while cutting as
+// few links as possible. The graph is coarsened by heavy-edge matching,
+// the coarsest graph is partitioned by growing parts breadth-first, and
+// the partition is refined by greedy moves of boundary nodes on each
+// level on the way back. Parts are written to the named column, indexed
+// by graph_node::index(). Nodes cost 1 unless a cost function is given.
+class partition_pass : public pass {
+public:
+    using result_type = partition_stats;
+    using cost_function = std::function<double(graph_node const*)>;
+
+    // Throws std::invalid_argument if parts is 0 or tolerance below 1.
+    partition_pass(std::uint32_t parts, cost_function const& cost = {},
+                   attribute_key const& column = "partition",
+                   double tolerance = 1.03);
+
+    any run(graph& graph, context& ctx) const override;
+
+private:
+    std::uint32_t parts;
+    cost_function cost;
+    attribute_key column;
+    double tolerance;
+};
+
+} /* namespace nodal */
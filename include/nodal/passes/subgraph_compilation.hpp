@@ -0,0 +1,52 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "../compiler.hpp"
+
+#include <unordered_map>
+
+namespace nodal
+{
+
+// Run body_pass, typically a compiler, once over the body of every
+// distinct subgraph in the graph, nested ones first, and collect the
+// results by body. Instances sharing a body share its result. A copy of
+// the body is passed in, with a context already holding the results for
+// the bodies nested in it, so that a subgraph_compilation_pass inside
+// body_pass finds them instead of compiling them again.
+class subgraph_compilation_pass : public pass {
+public:
+    using result_type = std::unordered_map<graph const*, any>;
+
+    subgraph_compilation_pass(pass const& body_pass) : body_pass(body_pass) {}
+
+    any run(graph& graph, context& ctx) const override;
+
+private:
+    pass const& body_pass;
+};
+
+} /* namespace nodal */
@@ -25,10 +25,19 @@
 #pragma once
 
 #include "../compiler.hpp"
+#include "../frozen_graph.hpp"
+#include "../graph_view.hpp"
+#include "../paged_graph.hpp"
+
+#include "../detail/vertex_scratch.hpp"
 
 #include <boost/graph/topological_sort.hpp>
+#include <boost/graph/two_bit_color_map.hpp>
+#include <boost/iterator/function_output_iterator.hpp>
 
+#include <algorithm>
 #include <iterator>
+#include <vector>
 
 namespace nodal
 {
@@ -39,17 +48,66 @@ public:
     using result_type = Container;
 
     any run(graph& graph, context& ctx) const override;
+    any run(frozen_graph const& graph, context& ctx) const;
+    any run(graph_view const& graph, context& ctx) const;
+
+    // Paged graphs have no node objects; the result is a
+    // std::vector<paged_graph::node_id> instead of a Container.
+    any run(paged_graph const& graph, context& ctx) const;
 };
 
 template <typename Container>
 any topological_sort_pass<Container>::run(graph& graph, context&) const {
     Container c;
+    detail::vertex_scratch<boost::default_color_type, nodal::graph> color(
+        graph);
+
+    boost::topological_sort(graph, std::front_inserter(c),
+                            boost::color_map(color.map()));
+
+    return std::move(c);
+}
+
+template <typename Container>
+any topological_sort_pass<Container>::run(frozen_graph const& graph,
+                                          context&) const {
+    Container c;
 
     boost::topological_sort(
-        graph, std::front_inserter(c),
-        boost::color_map(boost::get(boost::vertex_color, graph)));
+        graph, boost::make_function_output_iterator(
+                   [&c, &graph](frozen_graph::node_id id) {
+                       c.push_front(graph.node(id));
+                   }));
+
+    return std::move(c);
+}
+
+template <typename Container>
+any topological_sort_pass<Container>::run(graph_view const& graph,
+                                          context&) const {
+    Container c;
+
+    boost::topological_sort(graph, std::front_inserter(c));
 
     return std::move(c);
 }
 
+template <typename Container>
+any topological_sort_pass<Container>::run(paged_graph const& graph,
+                                          context&) const {
+    std::vector<paged_graph::node_id> order;
+    order.reserve(graph.node_count());
+
+    // Two bits per node keep the only per-node state small.
+    boost::two_bit_color_map<
+        boost::property_map<paged_graph, boost::vertex_index_t>::const_type>
+        color(graph.node_count(), boost::get(boost::vertex_index, graph));
+
+    boost::topological_sort(graph, std::back_inserter(order),
+                            boost::color_map(color));
+    std::reverse(order.begin(), order.end());
+
+    return std::move(order);
+}
+
 } /* namespace nodal */
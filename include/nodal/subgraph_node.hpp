@@ -0,0 +1,84 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "graph.hpp"
+#include "node.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace nodal
+{
+
+// Node standing for a whole graph, its body. Each of the node's sockets is
+// bound to a socket of a node in the body, given by its index(). The body
+// is immutable and shared: every graph_node referring to a subgraph_node,
+// and every subgraph_node built from the same body pointer, is an instance
+// of a single body, which passes can process once for all of them.
+class subgraph_node : public node {
+public:
+    struct port {
+        std::size_t node;
+        std::size_t socket;
+    };
+
+    // Throws std::out_of_range if a port names a missing node or socket.
+    subgraph_node(graph body, std::vector<port> inputs,
+                  std::vector<port> outputs);
+    subgraph_node(std::shared_ptr<graph const> body, std::vector<port> inputs,
+                  std::vector<port> outputs);
+
+    std::size_t input_count() const override {
+        return inputs_.size();
+    }
+
+    std::size_t output_count() const override {
+        return outputs_.size();
+    }
+
+    std::shared_ptr<graph const> const& body() const {
+        return body_;
+    }
+
+    // Input i feeds input socket inputs()[i].socket of body node
+    // inputs()[i].node.
+    std::vector<port> const& inputs() const {
+        return inputs_;
+    }
+
+    // Output i is output socket outputs()[i].socket of body node
+    // outputs()[i].node.
+    std::vector<port> const& outputs() const {
+        return outputs_;
+    }
+
+private:
+    std::shared_ptr<graph const> body_;
+    std::vector<port> inputs_;
+    std::vector<port> outputs_;
+};
+
+} /* namespace nodal */
@@ -27,6 +27,7 @@
 #include "detail/unused.hpp"
 
 #include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -269,6 +270,28 @@ public:
             data, index, param);
     }
 
+    // Append the binary form of the value to out: trivially copyable values
+    // as their bytes, strings and lists as a 64-bit length followed by their
+    // contents. Throws std::logic_error for pointers, other values that
+    // cannot be stored that way, and types that do not override it, rather
+    // than silently storing nothing.
+    virtual void serialize(node_data const* data, std::size_t index,
+                           std::vector<std::uint8_t>& out,
+                           bool param = false) const {
+        detail::unused(data, index, out, param);
+        throw std::logic_error("Type is not serializable");
+    }
+
+    // Read a value written by serialize() from [in, end), advancing in past
+    // it. Throws std::out_of_range if the input ends early, and
+    // std::logic_error like serialize().
+    virtual void deserialize(std::uint8_t const*& in, std::uint8_t const* end,
+                             node_data* data, std::size_t index,
+                             bool param = false) const {
+        detail::unused(in, end, data, index, param);
+        throw std::logic_error("Type is not serializable");
+    }
+
     operator type*()
     {
         return this;
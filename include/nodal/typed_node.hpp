@@ -29,6 +29,9 @@
 
 #include "detail/unused.hpp"
 
+#include <cstdint>
+#include <vector>
+
 namespace nodal
 {
 
@@ -48,6 +51,36 @@ public:
         detail::unused(index);
         return nullptr;
     }
+
+    // Append the inputs, then the parameters, of data in binary form, as
+    // written by their types' serialize(). Only declared inputs and
+    // parameters are written: other members of the data are not.
+    void serialize_data(node_data const* data,
+                        std::vector<std::uint8_t>& out) const {
+        for (std::size_t i = 0; i < input_count(); ++i) {
+            if (auto type = input_type(i))
+                type->serialize(data, i, out, false);
+        }
+
+        for (std::size_t i = 0; i < param_count(); ++i) {
+            if (auto type = param_type(i))
+                type->serialize(data, i, out, true);
+        }
+    }
+
+    // Restore data from the output of serialize_data(), advancing in.
+    void deserialize_data(std::uint8_t const*& in, std::uint8_t const* end,
+                          node_data* data) const {
+        for (std::size_t i = 0; i < input_count(); ++i) {
+            if (auto type = input_type(i))
+                type->deserialize(in, end, data, i, false);
+        }
+
+        for (std::size_t i = 0; i < param_count(); ++i) {
+            if (auto type = param_type(i))
+                type->deserialize(in, end, data, i, true);
+        }
+    }
 };
 
 } /* namespace nodal */
@@ -209,6 +209,24 @@ public:
         set_vector(value, data, index, param);
     }
 
+    void serialize(node_data const* data, std::size_t index,
+                   std::vector<std::uint8_t>& out,
+                   bool param = false) const override final {
+        if (param)
+            detail::generic_type_serialize(data->param<T>(index), out);
+        else
+            detail::generic_type_serialize(data->input<T>(index), out);
+    }
+
+    void deserialize(std::uint8_t const*& in, std::uint8_t const* end,
+                     node_data* data, std::size_t index,
+                     bool param = false) const override final {
+        if (param)
+            detail::generic_type_deserialize(data->param<T>(index), in, end);
+        else
+            detail::generic_type_deserialize(data->input<T>(index), in, end);
+    }
+
 protected:
     void* as_pointer(node_data const* data, std::size_t index,
                      bool param = false) const override final;
@@ -0,0 +1,99 @@
+/** -*- C++ -*-
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "graph.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace nodal
+{
+
+// Multi-version container for a graph that is read and edited by different
+// threads. Readers take a snapshot, an immutable version that stays valid
+// for as long as they hold it; writers edit a private copy of the latest
+// version and publish it atomically. Each version is freed when the last
+// snapshot of it is dropped.
+//
+// Copies share node data and attributes until they are written to, so a
+// new version costs one copy of the graph's structure. Writers are
+// serialised with each other by a mutex. Taking a snapshot takes no lock:
+// a reader only retries if a version is published while it is taking
+// one, and a writer only waits for readers in the middle of taking one.
+class versioned_graph {
+public:
+    using version = std::shared_ptr<graph const>;
+
+    versioned_graph();
+    explicit versioned_graph(graph initial);
+
+    versioned_graph(versioned_graph const&) = delete;
+    versioned_graph& operator=(versioned_graph const&) = delete;
+
+    ~versioned_graph();
+
+    version snapshot() const;
+
+    // Number of versions published so far.
+    std::uint64_t revision() const {
+        return revision_.load(std::memory_order_acquire);
+    }
+
+    // Apply fn to a copy of the latest version, then publish the copy.
+    // If fn throws, nothing is published.
+    template <typename Fn>
+    version edit(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(writer);
+
+        auto next = std::make_shared<graph>(**current.load());
+        fn(*next);
+
+        return publish(std::move(next));
+    }
+
+    // Publish an independently built graph as the latest version.
+    version assign(graph next);
+
+private:
+    version publish(std::shared_ptr<graph> next);
+
+    // The latest version is reached through a raw pointer to a heap copy
+    // of its shared_ptr. Readers announce themselves in the counter of the
+    // current epoch while they copy it; publish() moves to the next epoch
+    // and frees the replaced copy once the previous epoch's readers are
+    // done.
+    std::atomic<version const*> current;
+    mutable std::atomic<std::uint64_t> epoch { 0 };
+    mutable std::atomic<std::size_t> readers[2];
+
+    std::atomic<std::uint64_t> revision_ { 0 };
+    std::mutex writer;
+};
+
+} /* namespace nodal */
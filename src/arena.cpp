@@ -0,0 +1,129 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+using namespace nodal;
+
+namespace
+{
+
+thread_local arena* current_arena = nullptr;
+
+constexpr std::size_t header_size =
+    (sizeof(void*) * 2 + alignof(std::max_align_t) - 1) &
+    ~(alignof(std::max_align_t) - 1);
+
+char* chunk_begin(void* chunk) {
+    return static_cast<char*>(chunk) + header_size;
+}
+
+} /* namespace */
+
+arena::scope::scope(arena* arena) : previous(current_arena) {
+    current_arena = arena;
+}
+
+arena::scope::~scope() {
+    current_arena = previous;
+}
+
+arena::arena(std::size_t chunk_size) : chunk_size_(chunk_size) {}
+
+arena::~arena() {
+    while (chunks) {
+        auto next = chunks->next;
+        ::operator delete(chunks);
+        chunks = next;
+    }
+}
+
+void* arena::allocate(std::size_t size, std::size_t alignment) {
+    auto aligned = [alignment](char* p) {
+        auto addr = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<char*>((addr + alignment - 1) &
+                                       ~std::uintptr_t(alignment - 1));
+    };
+
+    auto p = ptr ? aligned(ptr) : nullptr;
+
+    if (!p || p > end || std::size_t(end - p) < size) {
+        grow(size + alignment);
+        p = aligned(ptr);
+    }
+
+    ptr = p + size;
+    return p;
+}
+
+void arena::release() {
+    if (!chunks)
+        return;
+
+    // Chunks grow geometrically, so the head of the list is the largest.
+    auto head = chunks;
+
+    while (head->next) {
+        auto next = head->next->next;
+        ::operator delete(head->next);
+        head->next = next;
+    }
+
+    ptr = chunk_begin(head);
+    end = ptr + head->size;
+}
+
+bool arena::owns(void const* p) const {
+    auto cp = static_cast<char const*>(p);
+
+    for (auto c = chunks; c; c = c->next) {
+        if (cp >= chunk_begin(c) && cp < chunk_begin(c) + c->size)
+            return true;
+    }
+
+    return false;
+}
+
+arena* arena::current() {
+    return current_arena;
+}
+
+void arena::grow(std::size_t min_size) {
+    auto size = std::max(chunk_size_, min_size);
+
+    if (chunks)
+        size = std::max(size, chunks->size * 2);
+
+    auto c = static_cast<chunk*>(::operator new(header_size + size));
+    c->next = chunks;
+    c->size = size;
+
+    chunks = c;
+    ptr = chunk_begin(c);
+    end = ptr + size;
+}
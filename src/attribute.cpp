@@ -0,0 +1,103 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "attribute.hpp"
+
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace nodal;
+
+namespace
+{
+
+class atom_table {
+public:
+    static atom_table& instance() {
+        static atom_table table;
+        return table;
+    }
+
+    std::uint32_t intern(std::string const& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = ids.find(name);
+
+        if (it != ids.end())
+            return it->second;
+
+        if (names.size() >= std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("atom::atom");
+
+        auto id = static_cast<std::uint32_t>(names.size());
+
+        names.push_back(name);
+        ids.emplace(name, id);
+
+        return id;
+    }
+
+    std::string const& name(std::uint32_t id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names[id];
+    }
+
+private:
+    atom_table() {
+        names.emplace_back();
+        ids.emplace(std::string(), 0);
+    }
+
+    std::mutex mutex;
+    std::deque<std::string> names;
+    std::unordered_map<std::string, std::uint32_t> ids;
+};
+
+} /* namespace */
+
+atom::atom(char const* name) : atom(std::string(name)) {}
+
+atom::atom(std::string const& name)
+    : id_(atom_table::instance().intern(name))
+    {}
+
+std::string const& atom::name() const {
+    return atom_table::instance().name(id_);
+}
+
+attribute_value& attribute_map::at(attribute_key key) {
+    auto it = find(key);
+
+    if (it == entries.end())
+        throw std::out_of_range("attribute_map::at");
+
+    return it->second;
+}
+
+attribute_value const& attribute_map::at(attribute_key key) const {
+    return const_cast<attribute_map*>(this)->at(key);
+}
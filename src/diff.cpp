@@ -0,0 +1,745 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "diff.hpp"
+#include "fingerprint.hpp"
+#include "node_order.hpp"
+
+#include "detail/generic_type.hpp"
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <unordered_map>
+
+using namespace nodal;
+
+namespace
+{
+
+constexpr std::uint32_t npos = frozen_graph::npos;
+
+// Bound on the candidates examined for each node when looking for one
+// with consistent inputs.
+constexpr std::size_t max_scan = 16;
+
+struct fingerprint_hash {
+    std::size_t operator()(fingerprint const& value) const {
+        return std::size_t(value.low ^ value.high);
+    }
+};
+
+bool link_less(frozen_link const& a, frozen_link const& b) {
+    return std::tie(a.source_node, a.source_socket,
+                    a.target_node, a.target_socket) <
+           std::tie(b.source_node, b.source_socket,
+                    b.target_node, b.target_socket);
+}
+
+std::string const* identity_of(graph_node const* node,
+                               attribute_key const& key) {
+    if (!node->has_attribute(key))
+        return nullptr;
+
+    auto const& value = node->attribute(key);
+
+    return (value.type() == typeid(std::string))
+               ? &value.cast<std::string>()
+               : nullptr;
+}
+
+// Incoming links of a node as (target socket, source, source socket)
+// triples, with sources mapped through source_index. Returns false if a
+// source has no index.
+template <typename SourceIndex>
+bool input_signature(graph const& graph, graph_node* node,
+                     SourceIndex source_index,
+                     std::vector<frozen_link>& signature) {
+    signature.clear();
+
+    auto range = graph.input_links(node);
+
+    for (auto it = range.first; it != range.second; ++it) {
+        auto source = source_index(it->source_node);
+
+        if (source == npos)
+            return false;
+
+        signature.push_back({ source, std::uint32_t(it->source_socket),
+                              0, std::uint32_t(it->target_socket) });
+    }
+
+    std::sort(signature.begin(), signature.end(), link_less);
+    return true;
+}
+
+std::size_t signature_hash(class node const* node,
+                           std::vector<frozen_link> const& signature) {
+    std::size_t seed = boost::hash_value(node);
+
+    for (auto const& link : signature) {
+        boost::hash_combine(seed, link.source_node);
+        boost::hash_combine(seed, link.source_socket);
+        boost::hash_combine(seed, link.target_socket);
+    }
+
+    return seed;
+}
+
+bool signature_equal(std::vector<frozen_link> const& a,
+                     std::vector<frozen_link> const& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](frozen_link const& x, frozen_link const& y) {
+                          return !link_less(x, y) && !link_less(y, x);
+                      });
+}
+
+// Hash of each node combined with the hashes of the nodes downstream of
+// it, the mirror image of the fingerprint's upstream hash. Links to nodes
+// on cycles contribute the target's local hash only.
+std::vector<std::size_t> downstream_hashes(graph const& graph,
+                                           graph_fingerprint const& hash) {
+    auto order = nodal::topological_order(graph);
+
+    std::vector<std::size_t> result(graph.node_count());
+    std::vector<bool> done(graph.node_count(), false);
+
+    auto local = [&](graph_node const* node) {
+        auto value = hash.local_value(node);
+        std::size_t seed = 0;
+
+        boost::hash_combine(seed, value.low);
+        boost::hash_combine(seed, value.high);
+        return seed;
+    };
+
+    for (auto i = order.rbegin(); i != order.rend(); ++i) {
+        auto node = *i;
+        std::size_t links = 0;
+
+        auto range = graph.output_links(node);
+
+        for (auto it = range.first; it != range.second; ++it) {
+            auto target = it->target_node->index();
+            std::size_t seed = done[target] ? result[target]
+                                            : local(it->target_node);
+
+            boost::hash_combine(seed, it->source_socket);
+            boost::hash_combine(seed, it->target_socket);
+            links += seed;
+        }
+
+        std::size_t seed = local(node);
+
+        boost::hash_combine(seed, links);
+        result[node->index()] = seed;
+        done[node->index()] = true;
+    }
+
+    return result;
+}
+
+patch::data_change data_change_of(std::uint32_t ref,
+                                  graph_node const* node) {
+    patch::data_change change = { ref, detail::data_encoding::none, {} };
+    change.encoding =
+        detail::encode_data(node->node(), node->data(), change.data);
+
+    if (change.encoding == detail::data_encoding::none && node->data())
+        throw std::invalid_argument("Node data cannot be stored in patch");
+
+    return change;
+}
+
+constexpr char patch_magic[8] = { 'N', 'O', 'D', 'A', 'L', 'P', 'A', 'T' };
+constexpr std::uint32_t patch_version = 1;
+
+template <typename T>
+void write_value(std::vector<std::uint8_t>& out, T const& value) {
+    detail::binary_write(out, &value, sizeof(value));
+}
+
+template <typename T>
+T read_value(std::uint8_t const*& in, std::uint8_t const* end) {
+    T value;
+    detail::binary_read(in, end, &value, sizeof(value));
+    return value;
+}
+
+void write_ids(std::vector<std::uint8_t>& out,
+               std::vector<std::uint32_t> const& ids) {
+    write_value(out, std::uint64_t(ids.size()));
+    detail::binary_write(out, ids.data(), ids.size() * sizeof(ids[0]));
+}
+
+std::vector<std::uint32_t> read_ids(std::uint8_t const*& in,
+                                    std::uint8_t const* end) {
+    std::vector<std::uint32_t> ids(detail::binary_read_length(in, end, 4));
+    detail::binary_read(in, end, ids.data(), ids.size() * sizeof(ids[0]));
+    return ids;
+}
+
+// Links are written with 32-bit sockets whatever the width of
+// frozen_socket.
+void write_links(std::vector<std::uint8_t>& out,
+                 std::vector<frozen_link> const& links) {
+    write_value(out, std::uint64_t(links.size()));
+
+    for (auto const& link : links) {
+        std::uint32_t fields[] = { link.source_node,
+                                   std::uint32_t(link.source_socket),
+                                   link.target_node,
+                                   std::uint32_t(link.target_socket) };
+        detail::binary_write(out, fields, sizeof(fields));
+    }
+}
+
+std::vector<frozen_link> read_links(std::uint8_t const*& in,
+                                    std::uint8_t const* end) {
+    std::vector<frozen_link> links(detail::binary_read_length(in, end, 16));
+
+    for (auto& link : links) {
+        std::uint32_t fields[4];
+        detail::binary_read(in, end, fields, sizeof(fields));
+
+        if (fields[1] > std::numeric_limits<frozen_socket>::max() ||
+            fields[3] > std::numeric_limits<frozen_socket>::max())
+            throw std::out_of_range("Socket index out of range");
+
+        link = frozen_link(fields[0], fields[1], fields[2], fields[3]);
+    }
+
+    return links;
+}
+
+} /* namespace */
+
+std::vector<std::uint8_t> patch::encode() const {
+    std::vector<std::uint8_t> out;
+
+    detail::binary_write(out, patch_magic, sizeof(patch_magic));
+    write_value(out, patch_version);
+    write_value(out, base_nodes);
+
+    write_ids(out, removed_nodes);
+    write_ids(out, added_nodes);
+    write_links(out, removed_links);
+    write_links(out, added_links);
+
+    write_value(out, std::uint64_t(data_changes.size()));
+
+    for (auto const& change : data_changes) {
+        write_value(out, change.node);
+        write_value(out, change.encoding);
+        write_value(out, std::uint64_t(change.data.size()));
+        detail::binary_write(out, change.data.data(), change.data.size());
+    }
+
+    return out;
+}
+
+patch patch::decode(std::uint8_t const* data, std::size_t size) {
+    auto in = data;
+    auto end = data + size;
+
+    char magic[sizeof(patch_magic)];
+    detail::binary_read(in, end, magic, sizeof(magic));
+
+    if (!std::equal(std::begin(magic), std::end(magic),
+                    std::begin(patch_magic)) ||
+        read_value<std::uint32_t>(in, end) != patch_version)
+        throw std::invalid_argument("Not a graph patch");
+
+    patch result;
+    result.base_nodes = read_value<std::uint32_t>(in, end);
+
+    result.removed_nodes = read_ids(in, end);
+    result.added_nodes = read_ids(in, end);
+    result.removed_links = read_links(in, end);
+    result.added_links = read_links(in, end);
+
+    // Each change takes at least its node, encoding and size.
+    result.data_changes.resize(detail::binary_read_length(in, end, 13));
+
+    for (auto& change : result.data_changes) {
+        change.node = read_value<std::uint32_t>(in, end);
+        change.encoding = read_value<detail::data_encoding>(in, end);
+
+        if (change.encoding > detail::data_encoding::serialized)
+            throw std::invalid_argument("Not a graph patch");
+
+        change.data.resize(detail::binary_read_length(in, end, 1));
+        detail::binary_read(in, end, change.data.data(), change.data.size());
+    }
+
+    if (in != end)
+        throw std::invalid_argument("Not a graph patch");
+
+    return result;
+}
+
+patch nodal::diff(graph const& from, graph const& to,
+                  std::vector<class node const*> const& types,
+                  attribute_key const& identity) {
+    if (from.node_count() >= npos || to.node_count() >= npos)
+        throw std::length_error("Too many nodes in graph");
+
+    auto from_nodes = from.nodes_begin();
+    auto to_nodes = to.nodes_begin();
+
+    auto const from_count = std::uint32_t(from.node_count());
+    auto const to_count = std::uint32_t(to.node_count());
+
+    std::vector<std::uint32_t> from_match(from_count, npos);
+    std::vector<std::uint32_t> to_match(to_count, npos);
+
+    auto match = [&](std::uint32_t f, std::uint32_t t) {
+        if (from_match[f] != npos ||
+            from_nodes[f]->node() != to_nodes[t]->node())
+            return false;
+
+        from_match[f] = t;
+        to_match[t] = f;
+        return true;
+    };
+
+    // Pair by identity attribute.
+    if (!identity.empty()) {
+        std::unordered_map<std::string, std::uint32_t> ids;
+
+        for (std::uint32_t f = 0; f < from_count; ++f) {
+            if (auto id = identity_of(from_nodes[f], identity))
+                ids.emplace(*id, f);
+        }
+
+        for (std::uint32_t t = 0; t < to_count; ++t) {
+            auto id = identity_of(to_nodes[t], identity);
+            auto it = id ? ids.find(*id) : ids.end();
+
+            if (it != ids.end())
+                match(it->second, t);
+        }
+    }
+
+    std::vector<std::uint32_t> to_order;
+    to_order.reserve(to_count);
+
+    for (auto node : topological_order(to))
+        to_order.push_back(std::uint32_t(node->index()));
+
+    std::vector<frozen_link> signature, other;
+
+    auto from_index = [](graph_node* node) {
+        return std::uint32_t(node->index());
+    };
+
+    auto to_index = [&to_match](graph_node* node) {
+        return to_match[node->index()];
+    };
+
+    // Pair nodes with identical contents and identical upstream graphs.
+    // Each pass prefers the node at the same position, which keeps
+    // patches between related graphs small when hashes are ambiguous.
+    graph_fingerprint from_hash(from);
+    graph_fingerprint to_hash(to);
+
+    // Nodes whose surroundings are identical both upstream and downstream
+    // go first, as they are the least ambiguous.
+    {
+        auto from_down = downstream_hashes(from, from_hash);
+        auto to_down = downstream_hashes(to, to_hash);
+
+        auto key = [](fingerprint const& up, std::size_t down) {
+            std::size_t seed = down;
+
+            boost::hash_combine(seed, up.low);
+            boost::hash_combine(seed, up.high);
+            return seed;
+        };
+
+        std::unordered_multimap<std::size_t, std::uint32_t> candidates;
+
+        for (std::uint32_t f = 0; f < from_count; ++f) {
+            if (from_match[f] == npos)
+                candidates.emplace(
+                    key(from_hash.value(from_nodes[f]), from_down[f]), f);
+        }
+
+        // Among equivalent candidates, prefer one whose inputs come from
+        // the nodes paired with t's inputs, then the one at t's position.
+        for (auto t : to_order) {
+            if (to_match[t] != npos)
+                continue;
+
+            auto hash = to_hash.value(to_nodes[t]);
+            bool mapped =
+                input_signature(to, to_nodes[t], to_index, signature);
+
+            auto equivalent = [&](std::uint32_t f) {
+                return from_match[f] == npos &&
+                       from_nodes[f]->node() == to_nodes[t]->node() &&
+                       from_down[f] == to_down[t] &&
+                       from_hash.value(from_nodes[f]) == hash;
+            };
+
+            auto consistent = [&](std::uint32_t f) {
+                return !mapped ||
+                       (input_signature(from, from_nodes[f], from_index,
+                                        other) &&
+                        signature_equal(signature, other));
+            };
+
+            if (t < from_count && equivalent(t) && consistent(t)) {
+                match(t, t);
+                continue;
+            }
+
+            auto range = candidates.equal_range(key(hash, to_down[t]));
+            auto chosen = range.second;
+            std::size_t scanned = 0;
+
+            for (auto it = range.first;
+                 it != range.second && scanned < max_scan; ++it) {
+                if (!equivalent(it->second))
+                    continue;
+
+                ++scanned;
+
+                if (consistent(it->second)) {
+                    chosen = it;
+                    break;
+                }
+            }
+
+            if (chosen != range.second) {
+                match(chosen->second, t);
+                candidates.erase(chosen);
+            } else if (t < from_count && equivalent(t)) {
+                match(t, t);
+            } else {
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (equivalent(it->second)) {
+                        match(it->second, t);
+                        candidates.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    {
+        std::unordered_multimap<fingerprint, std::uint32_t, fingerprint_hash>
+            candidates;
+
+        for (std::uint32_t f = 0; f < from_count; ++f) {
+            if (from_match[f] == npos)
+                candidates.emplace(from_hash.value(from_nodes[f]), f);
+        }
+
+        for (std::uint32_t t = 0; t < to_count; ++t) {
+            if (to_match[t] != npos)
+                continue;
+
+            auto hash = to_hash.value(to_nodes[t]);
+
+            if (t < from_count &&
+                from_hash.value(from_nodes[t]) == hash && match(t, t))
+                continue;
+
+            auto range = candidates.equal_range(hash);
+
+            for (auto it = range.first; it != range.second; ++it) {
+                if (match(it->second, t)) {
+                    candidates.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Pair nodes whose inputs come from paired nodes through the same
+    // sockets. Visiting sources first lets pairings extend downstream.
+    {
+        std::unordered_multimap<std::size_t, std::uint32_t> candidates;
+
+        for (std::uint32_t f = 0; f < from_count; ++f) {
+            if (from_match[f] == npos &&
+                input_signature(from, from_nodes[f], from_index, signature))
+                candidates.emplace(
+                    signature_hash(from_nodes[f]->node(), signature), f);
+        }
+
+        for (auto t : to_order) {
+            if (to_match[t] != npos ||
+                !input_signature(to, to_nodes[t], to_index, signature))
+                continue;
+
+            if (t < from_count && from_match[t] == npos &&
+                input_signature(from, from_nodes[t], from_index, other) &&
+                signature_equal(signature, other) && match(t, t))
+                continue;
+
+            auto range = candidates.equal_range(
+                signature_hash(to_nodes[t]->node(), signature));
+
+            for (auto it = range.first; it != range.second; ++it) {
+                input_signature(from, from_nodes[it->second], from_index,
+                                other);
+
+                if (signature_equal(signature, other) &&
+                    match(it->second, t)) {
+                    candidates.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Pair the remaining nodes by node alone.
+    {
+        std::unordered_multimap<class node const*, std::uint32_t> candidates;
+
+        for (std::uint32_t f = 0; f < from_count; ++f) {
+            if (from_match[f] == npos)
+                candidates.emplace(from_nodes[f]->node(), f);
+        }
+
+        for (std::uint32_t t = 0; t < to_count; ++t) {
+            if (to_match[t] != npos)
+                continue;
+
+            if (t < from_count && match(t, t))
+                continue;
+
+            auto range = candidates.equal_range(to_nodes[t]->node());
+
+            for (auto it = range.first; it != range.second; ++it) {
+                if (match(it->second, t)) {
+                    candidates.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+
+    patch result;
+    result.base_nodes = from_count;
+
+    for (std::uint32_t f = 0; f < from_count; ++f) {
+        if (from_match[f] == npos)
+            result.removed_nodes.push_back(f);
+    }
+
+    std::unordered_map<class node const*, std::uint32_t> type_ids;
+    type_ids.reserve(types.size());
+
+    for (std::size_t i = 0; i < types.size(); ++i)
+        type_ids.emplace(types[i], std::uint32_t(i));
+
+    // References of to's nodes in patch space.
+    std::vector<std::uint32_t> refs(to_count);
+    std::vector<std::uint8_t> old_data, new_data;
+
+    for (std::uint32_t t = 0; t < to_count; ++t) {
+        graph_node const* node = to_nodes[t];
+
+        if (to_match[t] != npos) {
+            refs[t] = to_match[t];
+
+            graph_node const* old = from_nodes[to_match[t]];
+
+            if (old->data() == node->data())
+                continue;
+
+            // Data that can be stored neither way is taken as changed.
+            old_data.clear();
+            new_data.clear();
+
+            auto old_encoding =
+                detail::encode_data(old->node(), old->data(), old_data);
+            auto new_encoding =
+                detail::encode_data(node->node(), node->data(), new_data);
+
+            if (old_encoding != new_encoding || old_data != new_data ||
+                new_encoding == detail::data_encoding::none)
+                result.data_changes.push_back(data_change_of(refs[t], node));
+        } else {
+            auto type = type_ids.find(node->node());
+
+            if (type == type_ids.end())
+                throw std::invalid_argument("Node type not in type table");
+
+            refs[t] = from_count + std::uint32_t(result.added_nodes.size());
+            result.added_nodes.push_back(type->second);
+
+            if (node->data())
+                result.data_changes.push_back(data_change_of(refs[t], node));
+        }
+    }
+
+    // Links between surviving nodes, in patch space.
+    std::vector<frozen_link> old_links, new_links;
+    old_links.reserve(from.link_count());
+    new_links.reserve(to.link_count());
+
+    for (auto it = from.links_begin(); it != from.links_end(); ++it) {
+        auto const& link = *it;
+        auto source = std::uint32_t(link.source_node->index());
+        auto target = std::uint32_t(link.target_node->index());
+
+        if (from_match[source] != npos && from_match[target] != npos)
+            old_links.push_back({ source, std::uint32_t(link.source_socket),
+                                  target, std::uint32_t(link.target_socket) });
+    }
+
+    for (auto it = to.links_begin(); it != to.links_end(); ++it) {
+        auto const& link = *it;
+        new_links.push_back({ refs[link.source_node->index()],
+                              std::uint32_t(link.source_socket),
+                              refs[link.target_node->index()],
+                              std::uint32_t(link.target_socket) });
+    }
+
+    std::sort(old_links.begin(), old_links.end(), link_less);
+    std::sort(new_links.begin(), new_links.end(), link_less);
+
+    std::set_difference(old_links.begin(), old_links.end(),
+                        new_links.begin(), new_links.end(),
+                        std::back_inserter(result.removed_links), link_less);
+    std::set_difference(new_links.begin(), new_links.end(),
+                        old_links.begin(), old_links.end(),
+                        std::back_inserter(result.added_links), link_less);
+
+    return result;
+}
+
+void nodal::apply(graph& graph, patch const& patch,
+                  std::vector<class node const*> const& types) {
+    if (graph.node_count() != patch.base_nodes)
+        throw std::invalid_argument("Patch does not match graph");
+
+    auto const base = std::size_t(patch.base_nodes);
+    auto const count = base + patch.added_nodes.size();
+
+    // Check the whole patch up front so that a bad patch leaves the graph
+    // untouched.
+    std::vector<graph_node*> nodes(graph.nodes_begin(), graph.nodes_end());
+    std::vector<class node const*> node_types;
+    node_types.reserve(count);
+
+    for (auto node : nodes)
+        node_types.push_back(node->node());
+
+    for (auto type : patch.added_nodes) {
+        if (type >= types.size())
+            throw std::out_of_range("Node type id out of range");
+
+        node_types.push_back(types[type]);
+    }
+
+    std::vector<bool> removed(base, false);
+
+    for (auto ref : patch.removed_nodes) {
+        if (ref >= base || removed[ref])
+            throw std::out_of_range("Node reference out of range");
+
+        removed[ref] = true;
+    }
+
+    auto check = [&](std::uint32_t ref, std::size_t limit) {
+        if (ref >= limit || (ref < base && removed[ref]))
+            throw std::out_of_range("Node reference out of range");
+    };
+
+    auto check_link = [&](frozen_link const& link, std::size_t limit) {
+        check(link.source_node, limit);
+        check(link.target_node, limit);
+
+        auto source = node_types[link.source_node];
+        auto target = node_types[link.target_node];
+
+        if (!source || link.source_socket >= source->output_count() ||
+            !target || link.target_socket >= target->input_count())
+            throw std::out_of_range("Socket index out of range");
+    };
+
+    for (auto const& link : patch.removed_links)
+        check_link(link, base);
+
+    for (auto const& link : patch.added_links)
+        check_link(link, count);
+
+    // New data is decoded into scratch objects, copied in below.
+    std::vector<std::unique_ptr<node_data>> data;
+    data.reserve(patch.data_changes.size());
+
+    {
+        arena::scope scope(nullptr);
+
+        for (auto const& change : patch.data_changes) {
+            check(change.node, count);
+
+            auto type = node_types[change.node];
+            std::unique_ptr<node_data> scratch;
+
+            if (change.encoding != detail::data_encoding::none)
+                scratch.reset(type ? type->data() : nullptr);
+
+            detail::decode_data(type, scratch.get(), change.encoding,
+                                change.data.data(), change.data.size());
+            data.push_back(std::move(scratch));
+        }
+    }
+
+    nodes.reserve(count);
+
+    for (auto const& link : patch.removed_links) {
+        graph.unlink(graph_link(nodes[link.source_node], link.source_socket,
+                                nodes[link.target_node], link.target_socket));
+    }
+
+    for (auto ref : patch.removed_nodes) {
+        graph.remove(nodes[ref]);
+        nodes[ref] = nullptr;
+    }
+
+    for (auto type : patch.added_nodes)
+        nodes.push_back(graph.add(types[type]));
+
+    for (std::size_t i = 0; i < data.size(); ++i)
+        nodes[patch.data_changes[i].node]->set_data(data[i].get());
+
+    for (auto const& link : patch.added_links) {
+        graph.link(nodes[link.source_node], link.source_socket,
+                   nodes[link.target_node], link.target_socket);
+    }
+}
@@ -0,0 +1,462 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "fingerprint.hpp"
+#include "typed_node.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <typeinfo>
+
+using namespace nodal;
+
+namespace
+{
+
+std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+class hasher {
+public:
+    void add(std::uint64_t value) {
+        a = mix(a ^ value);
+        b = mix(b + (value ^ (a << 1 | a >> 63)));
+    }
+
+    void add(double value) {
+        std::uint64_t bits;
+
+        if (value == 0.0)
+            value = 0.0;
+
+        std::memcpy(&bits, &value, sizeof(bits));
+        add(bits);
+    }
+
+    void add(std::string const& value) {
+        add(std::uint64_t(value.size()));
+
+        for (std::size_t i = 0; i < value.size(); i += 8) {
+            std::uint64_t chunk = 0;
+            std::memcpy(&chunk, value.data() + i,
+                        std::min<std::size_t>(8, value.size() - i));
+            add(chunk);
+        }
+    }
+
+    void add(fingerprint const& value) {
+        add(value.low);
+        add(value.high);
+    }
+
+    template <typename T>
+    void add(std::vector<T> const& values) {
+        add(std::uint64_t(values.size()));
+
+        for (auto const& value : values)
+            add(convert(value));
+    }
+
+    void add(std::vector<bool> const& values) {
+        add(std::uint64_t(values.size()));
+
+        for (bool value : values)
+            add(std::uint64_t(value));
+    }
+
+    fingerprint result() const {
+        return { mix(a ^ 0x9e3779b97f4a7c15ull), mix(b) };
+    }
+
+private:
+    template <typename T>
+    static std::uint64_t convert(T value) {
+        return std::uint64_t(value);
+    }
+
+    static double convert(double value) {
+        return value;
+    }
+
+    static std::string const& convert(std::string const& value) {
+        return value;
+    }
+
+    std::uint64_t a = 0x243f6a8885a308d3ull;
+    std::uint64_t b = 0x13198a2e03707344ull;
+};
+
+void accumulate(fingerprint& sum, fingerprint const& value) {
+    sum.low += value.low;
+    sum.high += value.high + (sum.low < value.low);
+}
+
+void subtract(fingerprint& sum, fingerprint const& value) {
+    sum.high -= value.high + (sum.low < value.low);
+    sum.low -= value.low;
+}
+
+void hash_value(hasher& h, type const* type, node_data const* data,
+                std::size_t index, bool param) {
+    if (!type) {
+        h.add(std::uint64_t(type::none));
+        return;
+    }
+
+    h.add(std::uint64_t(type->repr()));
+
+    if (type->is_vector() || type->is_list()) {
+        switch (type->repr()) {
+        case type::boolean:
+            h.add(type->as_bool_vector(data, index, param));
+            break;
+        case type::byte:
+            h.add(type->as_byte_vector(data, index, param));
+            break;
+        case type::integer:
+            h.add(type->as_int_vector(data, index, param));
+            break;
+        case type::unsigned_int:
+            h.add(type->as_uint_vector(data, index, param));
+            break;
+        case type::real:
+            h.add(type->as_real_vector(data, index, param));
+            break;
+        case type::string:
+            h.add(type->as_string_vector(data, index, param));
+            break;
+        default:
+            break;
+        }
+    } else {
+        switch (type->repr()) {
+        case type::boolean:
+            h.add(std::uint64_t(type->as_bool(data, index, param)));
+            break;
+        case type::byte:
+            h.add(std::uint64_t(type->as_byte(data, index, param)));
+            break;
+        case type::integer:
+            h.add(std::uint64_t(type->as_int(data, index, param)));
+            break;
+        case type::unsigned_int:
+            h.add(std::uint64_t(type->as_uint(data, index, param)));
+            break;
+        case type::real:
+            h.add(type->as_real(data, index, param));
+            break;
+        case type::string:
+            h.add(type->as_string(data, index, param));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+fingerprint local_hash(graph_node const* gnode) {
+    hasher h;
+    auto node = gnode->node();
+
+    if (!node)
+        return h.result();
+
+    h.add(std::string(typeid(*node).name()));
+    h.add(std::uint64_t(node->input_count()));
+    h.add(std::uint64_t(node->output_count()));
+    h.add(std::uint64_t(node->param_count()));
+
+    auto typed = dynamic_cast<typed_node const*>(node);
+    auto data = gnode->data();
+
+    if (typed && data) {
+        for (std::size_t i = 0; i < node->input_count(); ++i)
+            hash_value(h, typed->input_type(i), data, i, false);
+
+        for (std::size_t i = 0; i < node->param_count(); ++i)
+            hash_value(h, typed->param_type(i), data, i, true);
+    }
+
+    return h.result();
+}
+
+} /* namespace */
+
+graph_fingerprint::graph_fingerprint(graph const& graph)
+    : graph_(graph)
+{
+    rehash();
+}
+
+void graph_fingerprint::update() {
+    if (journal && journal == graph_.journal() &&
+        cursor.position == journal->head())
+        return;
+
+    if (!journal || journal != graph_.journal() || cyclic) {
+        rehash();
+        return;
+    }
+
+    bool reset = false;
+    bool complete = journal->read(cursor, [this, &reset](graph_event e) {
+        switch (e.kind) {
+        case graph_event::node_added:
+        case graph_event::data_changed:
+            touch(e.node, true);
+            break;
+        case graph_event::node_removed:
+            forget(e.node);
+            break;
+        case graph_event::linked:
+        case graph_event::unlinked:
+            touch(e.target, false);
+            break;
+        case graph_event::attribute_changed:
+            break;
+        case graph_event::links_cleared:
+        case graph_event::cleared:
+            reset = true;
+            break;
+        }
+    });
+
+    if (!complete || reset)
+        rehash();
+    else
+        propagate(false);
+}
+
+void graph_fingerprint::rehash() {
+    journal = graph_.journal();
+    if (journal)
+        cursor = journal->sync();
+
+    entries.clear();
+    dirty.clear();
+    total = fingerprint();
+    cyclic = false;
+
+    for (auto it = graph_.nodes_begin(); it != graph_.nodes_end(); ++it)
+        dirty.push_back((*it)->handle());
+
+    propagate(true);
+}
+
+fingerprint graph_fingerprint::value(graph_node const* node) const {
+    return find(node).full;
+}
+
+fingerprint graph_fingerprint::local_value(graph_node const* node) const {
+    return find(node).local;
+}
+
+graph_fingerprint::entry const&
+graph_fingerprint::find(graph_node const* node) const {
+    if (!node || graph_.find(node->handle()) != node ||
+        node->handle().id >= entries.size())
+        throw std::out_of_range("Node not in graph");
+
+    return entries[node->handle().id];
+}
+
+graph_fingerprint::entry& graph_fingerprint::at(node_handle handle) {
+    if (handle.id >= entries.size())
+        entries.resize(handle.id + 1);
+
+    auto& e = entries[handle.id];
+
+    if (e.generation != handle.generation) {
+        if (e.valid)
+            subtract(total, e.full);
+
+        e = entry();
+        e.generation = handle.generation;
+    }
+
+    return e;
+}
+
+void graph_fingerprint::touch(node_handle handle, bool data) {
+    if (!graph_.find(handle))
+        return;
+
+    if (data)
+        at(handle).local_valid = false;
+
+    dirty.push_back(handle);
+}
+
+void graph_fingerprint::forget(node_handle handle) {
+    if (handle.id >= entries.size() ||
+        entries[handle.id].generation != handle.generation)
+        return;
+
+    auto& e = entries[handle.id];
+
+    if (e.valid)
+        subtract(total, e.full);
+
+    e = entry();
+    e.generation = handle.generation;
+}
+
+void graph_fingerprint::propagate(bool full) {
+    if (++epoch == 0) {
+        for (auto& e : entries)
+            e.mark = 0;
+
+        epoch = 1;
+    }
+
+    // Collect the changed nodes and everything downstream of them.
+    std::vector<graph_node*> cone;
+
+    auto visit = [this, &cone](graph_node* node) {
+        auto& e = at(node->handle());
+
+        if (e.mark != epoch) {
+            e.mark = epoch;
+            e.pending = 0;
+            cone.push_back(node);
+        }
+    };
+
+    for (auto handle : dirty) {
+        if (auto node = graph_.find(handle))
+            visit(node);
+    }
+
+    dirty.clear();
+
+    for (std::size_t i = 0; i < cone.size(); ++i) {
+        auto range = graph_.output_links(cone[i]);
+
+        for (auto it = range.first; it != range.second; ++it)
+            visit(it->target_node);
+    }
+
+    for (auto node : cone) {
+        auto range = graph_.output_links(node);
+
+        for (auto it = range.first; it != range.second; ++it)
+            ++entries[it->target_node->handle().id].pending;
+    }
+
+    // Rehash the cone in topological order, so that every node sees the
+    // final hashes of its sources.
+    std::vector<graph_node*> ready;
+    std::size_t done = 0;
+
+    for (auto node : cone) {
+        if (entries[node->handle().id].pending == 0)
+            ready.push_back(node);
+    }
+
+    while (!ready.empty()) {
+        auto node = ready.back();
+        ready.pop_back();
+        ++done;
+
+        assign(node, hash(node, false));
+
+        auto range = graph_.output_links(node);
+
+        for (auto it = range.first; it != range.second; ++it) {
+            if (--entries[it->target_node->handle().id].pending == 0)
+                ready.push_back(it->target_node);
+        }
+    }
+
+    if (done == cone.size())
+        return;
+
+    // The cone contains a cycle. Incremental results would depend on the
+    // order of edits, so start over; a full pass hashes the nodes left on
+    // or below cycles from the local hashes of their sources only.
+    if (!full) {
+        rehash();
+        return;
+    }
+
+    cyclic = true;
+
+    for (auto node : cone) {
+        if (entries[node->handle().id].pending != 0)
+            assign(node, hash(node, true));
+    }
+}
+
+void graph_fingerprint::assign(graph_node* node, fingerprint const& hash) {
+    auto& e = entries[node->handle().id];
+
+    if (e.valid)
+        subtract(total, e.full);
+
+    e.full = hash;
+    e.valid = true;
+
+    accumulate(total, hash);
+}
+
+fingerprint const& graph_fingerprint::local(graph_node* node) {
+    auto& e = at(node->handle());
+
+    if (!e.local_valid) {
+        e.local = local_hash(node);
+        e.local_valid = true;
+    }
+
+    return e.local;
+}
+
+fingerprint graph_fingerprint::hash(graph_node* node, bool shallow) {
+    fingerprint links;
+    std::uint64_t count = 0;
+
+    auto range = graph_.input_links(node);
+
+    for (auto it = range.first; it != range.second; ++it, ++count) {
+        hasher h;
+        h.add(std::uint64_t(it->target_socket));
+        h.add(std::uint64_t(it->source_socket));
+        h.add(shallow ? local(it->source_node)
+                      : entries[it->source_node->handle().id].full);
+
+        accumulate(links, h.result());
+    }
+
+    hasher h;
+    h.add(local(node));
+    h.add(count);
+    h.add(links);
+
+    return h.result();
+}
@@ -0,0 +1,167 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "frozen_graph.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+using namespace nodal;
+
+namespace
+{
+
+// Both ranges are sorted by socket within a node, so the links of a single
+// socket form a contiguous run.
+template <frozen_socket frozen_link::*Socket, typename Iterator>
+std::pair<Iterator, Iterator> socket_range(frozen_graph const& graph,
+                                           std::pair<Iterator, Iterator> range,
+                                           std::uint32_t socket) {
+    auto first = std::lower_bound(
+        range.first, range.second, socket,
+        [&graph](frozen_graph::link_id link, std::uint32_t socket) {
+            return graph.link(link).*Socket < socket;
+        });
+
+    auto last = std::upper_bound(
+        first, range.second, socket,
+        [&graph](std::uint32_t socket, frozen_graph::link_id link) {
+            return socket < graph.link(link).*Socket;
+        });
+
+    return { first, last };
+}
+
+} /* namespace */
+
+frozen_graph::frozen_graph(graph const& graph)
+    : nodes_(graph.nodes_begin(), graph.nodes_end()),
+      links_(graph.link_count()),
+      output_offsets_(graph.node_count() + 1, 0)
+{
+    if (nodes_.size() >= npos || links_.size() >= npos)
+        throw std::length_error("Graph too large to freeze");
+
+    for (auto it = graph.links_begin(); it != graph.links_end(); ++it) {
+        if (it->source_socket > std::numeric_limits<frozen_socket>::max() ||
+            it->target_socket > std::numeric_limits<frozen_socket>::max())
+            throw std::length_error("Socket index too large to freeze");
+
+        ++output_offsets_[it->source_node->index() + 1];
+    }
+
+    std::partial_sum(output_offsets_.begin(), output_offsets_.end(),
+                     output_offsets_.begin());
+
+    // Bucket links by source node, then order each bucket by socket.
+    std::vector<std::uint32_t> cursor(output_offsets_.begin(),
+                                      output_offsets_.end() - 1);
+
+    for (auto it = graph.links_begin(); it != graph.links_end(); ++it) {
+        auto source = it->source_node->index();
+
+        links_[cursor[source]++] = {
+            node_id(source), std::uint32_t(it->source_socket),
+            node_id(it->target_node->index()), std::uint32_t(it->target_socket)
+        };
+    }
+
+    for (std::size_t n = 0; n < nodes_.size(); ++n) {
+        std::sort(links_.begin() + output_offsets_[n],
+                  links_.begin() + output_offsets_[n + 1],
+                  [](frozen_link const& a, frozen_link const& b) {
+                      return std::tie(a.source_socket, a.target_node,
+                                      a.target_socket) <
+                             std::tie(b.source_socket, b.target_node,
+                                      b.target_socket);
+                  });
+    }
+
+    build_input_index();
+}
+
+frozen_graph::frozen_graph(std::vector<graph_node*> nodes,
+                           std::vector<frozen_link> links)
+    : nodes_(std::move(nodes)), links_(std::move(links)),
+      output_offsets_(nodes_.size() + 1, 0)
+{
+    for (auto const& link : links_)
+        ++output_offsets_[link.source_node + 1];
+
+    std::partial_sum(output_offsets_.begin(), output_offsets_.end(),
+                     output_offsets_.begin());
+
+    build_input_index();
+}
+
+void frozen_graph::build_input_index() {
+    input_offsets_.assign(nodes_.size() + 1, 0);
+    input_index_.resize(links_.size());
+
+    for (auto const& link : links_)
+        ++input_offsets_[link.target_node + 1];
+
+    std::partial_sum(input_offsets_.begin(), input_offsets_.end(),
+                     input_offsets_.begin());
+
+    // Bucket links by target node, then order each bucket by socket.
+    std::vector<std::uint32_t> cursor(input_offsets_.begin(),
+                                      input_offsets_.end() - 1);
+
+    for (link_id l = 0; l < links_.size(); ++l)
+        input_index_[cursor[links_[l].target_node]++] = l;
+
+    for (std::size_t n = 0; n < nodes_.size(); ++n) {
+        std::sort(input_index_.begin() + input_offsets_[n],
+                  input_index_.begin() + input_offsets_[n + 1],
+                  [this](link_id a, link_id b) {
+                      auto const& la = links_[a];
+                      auto const& lb = links_[b];
+
+                      return std::tie(la.target_socket, la.source_node,
+                                      la.source_socket) <
+                             std::tie(lb.target_socket, lb.source_node,
+                                      lb.source_socket);
+                  });
+    }
+}
+
+frozen_graph::input_link_range
+frozen_graph::input_links(node_id node, std::uint32_t socket) const {
+    return socket_range<&frozen_link::target_socket>(*this, input_links(node),
+                                                     socket);
+}
+
+frozen_graph::output_link_range
+frozen_graph::output_links(node_id node, std::uint32_t socket) const {
+    return socket_range<&frozen_link::source_socket>(*this, output_links(node),
+                                                     socket);
+}
+
+frozen_graph graph::freeze() const {
+    return frozen_graph(*this);
+}
@@ -26,87 +26,389 @@
 
 #include <algorithm>
 #include <stdexcept>
-#include <unordered_map>
+#include <tuple>
 
 using namespace nodal;
 
-graph::graph(graph const& other) {
-    std::unordered_map<graph_node*, graph_node*> node_map;
+graph::graph(arena_mode_t, std::size_t chunk_size)
+    : arena_(new arena(chunk_size)), links_(arena_.get())
+    {}
 
-    for (auto node : other.nodes_) {
-        node_map.emplace(node, add(new graph_node(*node)));
+graph::graph(graph const& other)
+    : arena_(other.arena_ ? new arena(other.arena_->chunk_size()) : nullptr),
+      nodes_(other.nodes_), links_(arena_.get())
+{
+    for (auto it = nodes_.begin(); it != nodes_.end(); ++it) {
+        if (arena_) {
+            nodes_.replace(it, new (arena_->allocate(sizeof(graph_node),
+                                                     alignof(graph_node)))
+                                   graph_node(**it, arena_.get()));
+        } else {
+            nodes_.replace(it, new graph_node(**it));
+        }
     }
 
-    for (auto link : other.links_) {
-        this->link(node_map.at(link.source_node), link.source_socket,
-                   node_map.at(link.target_node), link.target_socket);
+    // Insert links in index order, so that they keep their indices.
+    link_index_.reserve(other.link_index_.size());
+
+    for (auto link : other.link_index_) {
+        attach(*links_.emplace(nodes_[link->source_node->index()],
+                               link->source_socket,
+                               nodes_[link->target_node->index()],
+                               link->target_socket).first);
     }
+
+    copy_columns(columns_, other.columns_);
+    copy_columns(link_columns_, other.link_columns_);
 }
 
 graph::graph(graph&& other)
-    : nodes_(std::move(other.nodes_)), links_(std::move(other.links_))
-    {}
+    : arena_(std::move(other.arena_)), block_(std::move(other.block_)),
+      journal_(std::move(other.journal_)),
+      nodes_(std::move(other.nodes_)), links_(std::move(other.links_)),
+      link_index_(std::move(other.link_index_)),
+      columns_(std::move(other.columns_)),
+      link_columns_(std::move(other.link_columns_))
+{
+    // Detach the moved-from link container from our arena.
+    other.links_ = detail::link_list();
+}
 
 graph::~graph() {
-    for (auto node : nodes_)
-        delete node;
+    nodes_.clear_and_dispose([this](graph_node* node) { dispose(node); });
 }
 
 graph& graph::operator=(graph const& other) {
-    std::unordered_map<graph_node*, graph_node*> node_map;
+    graph copy(other);
+    return *this = std::move(copy);
+}
 
-    clear();
+graph& graph::operator=(graph&& other) {
+    std::swap(arena_, other.arena_);
+    std::swap(block_, other.block_);
+    std::swap(journal_, other.journal_);
+    nodes_.swap(other.nodes_);
+    std::swap(links_, other.links_);
+    link_index_.swap(other.link_index_);
+    columns_.swap(other.columns_);
+    link_columns_.swap(other.link_columns_);
 
-    for (auto node : other.nodes_) {
-        node_map.emplace(node, add(new graph_node(*node)));
-    }
+    return *this;
+}
 
-    for (auto link : other.links_) {
-        this->link(node_map.at(link.source_node), link.source_socket,
-                   node_map.at(link.target_node), link.target_socket);
-    }
+void graph::enable_journal(std::size_t capacity) {
+    journal_.reset(new graph_journal(capacity));
 
-    return *this;
+    for (auto node : nodes_)
+        node->journal_ = journal_.get();
 }
 
-graph& graph::operator=(graph&& other) {
-    std::swap(nodes_, other.nodes_);
-    std::swap(links_, other.links_);
+void graph::disable_journal() {
+    for (auto node : nodes_)
+        node->journal_ = nullptr;
 
-    return *this;
+    journal_.reset();
 }
 
 void graph::clear() {
-    for (auto node : nodes_)
-        delete node;
+    nodes_.clear_and_dispose([this](graph_node* node) { dispose(node); });
+    links_.clear();
+    link_index_.clear();
+
+    for (auto& column : columns_)
+        column.second->clear();
 
-    nodes_.clear();
+    for (auto& column : link_columns_)
+        column.second->clear();
+
+    if (arena_)
+        release_arena();
+
+    block_.reset();
+    record(graph_event::cleared);
+}
+
+void graph::clear_links() {
     links_.clear();
+    link_index_.clear();
+
+    for (auto& column : link_columns_)
+        column.second->clear();
+
+    record(graph_event::links_cleared);
+}
+
+graph_node* graph::add(class node const* node) {
+    graph_node* gnode;
+
+    if (arena_) {
+        gnode = new (arena_->allocate(sizeof(graph_node), alignof(graph_node)))
+            graph_node(node, arena_.get());
+    } else {
+        gnode = new graph_node(node);
+    }
+
+    nodes_.insert(gnode);
+    attach(gnode);
+    grow_columns();
+
+    return gnode;
 }
 
 graph::node_iterator graph::remove(node_iterator iter) {
+    std::size_t index = iter - nodes_.begin();
+
     unlink(iter);
-    delete *iter;
-    return nodes_.erase(iter);
+
+    for (auto& column : columns_)
+        column.second->erase(index);
+
+    return nodes_.erase_and_dispose(
+        iter, [this](graph_node* node) { retire(node); });
 }
 
 graph::node_iterator graph::remove(node_range range) {
-    for (auto it = range.first; it != range.second; ++it) {
-        unlink(it);
-        delete *it;
+    std::size_t first = range.first - nodes_.begin();
+    std::size_t last = range.second - nodes_.begin();
+
+    boost::dynamic_bitset<> mask(last);
+    mask.set(first, last - first, true);
+    remove(mask);
+
+    return nodes_.begin() + first;
+}
+
+void graph::remove(boost::dynamic_bitset<> const& mask) {
+    if (mask.size() > nodes_.size())
+        throw std::out_of_range("Node mask larger than graph");
+
+    auto count = mask.count();
+
+    if (count == 0)
+        return;
+
+    // Unlinking node by node costs a search per node; past a few nodes, a
+    // sweep over all links is cheaper.
+    if (count * 16 < nodes_.size()) {
+        for (auto i = mask.find_first(); i != mask.npos; i = mask.find_next(i))
+            unlink(nodes_[i]);
+    } else {
+        auto doomed = [&](graph_node const* node) {
+            return node->index() < mask.size() && mask[node->index()];
+        };
+
+        boost::dynamic_bitset<> removed(link_index_.size());
+
+        for (std::size_t i = 0; i < link_index_.size(); ++i) {
+            auto link = link_index_[i];
+
+            if (doomed(link->source_node) || doomed(link->target_node)) {
+                record(graph_event::unlinked, *link);
+                removed.set(i);
+            }
+        }
+
+        // Erasing a link touches every index of the container, and so does
+        // inserting one, at a higher cost. Once most links go, rebuilding
+        // the container from the survivors is cheaper than erasing the
+        // rest; survivors are inserted in source order, so that insertions
+        // into the source index are hinted.
+        if ((link_index_.size() - removed.count()) * 5 < link_index_.size()) {
+            std::vector<graph_link> kept;
+            kept.reserve(link_index_.size() - removed.count());
+
+            for (std::size_t i = 0; i < link_index_.size(); ++i) {
+                if (!removed[i]) {
+                    kept.push_back(*link_index_[i]);
+                    kept.back().index_ =
+                        static_cast<std::uint32_t>(kept.size() - 1);
+                }
+            }
+
+            std::sort(kept.begin(), kept.end(),
+                      [](graph_link const& a, graph_link const& b) {
+                          return std::tie(a.source_node, a.source_socket,
+                                          a.target_node, a.target_socket) <
+                                 std::tie(b.source_node, b.source_socket,
+                                          b.target_node, b.target_socket);
+                      });
+
+            links_.clear();
+            link_index_.resize(kept.size());
+
+            auto& by_source = links_.get<detail::source_index>();
+
+            for (auto const& link : kept) {
+                auto it = by_source.insert(by_source.end(), link);
+                link_index_[link.index_] = &*it;
+            }
+        } else {
+            std::size_t next = 0;
+
+            for (std::size_t i = 0; i < link_index_.size(); ++i) {
+                auto link = link_index_[i];
+
+                if (removed[i]) {
+                    links_.erase(links_.iterator_to(*link));
+                    continue;
+                }
+
+                link_index_[next] = link;
+                link_index_[next]->index_ = static_cast<std::uint32_t>(next);
+                ++next;
+            }
+
+            link_index_.resize(next);
+        }
+
+        for (auto& column : link_columns_)
+            column.second->erase(removed);
     }
 
-    return nodes_.erase(range.first, range.second);
+    for (auto& column : columns_)
+        column.second->erase(mask);
+
+    nodes_.erase_and_dispose(mask,
+                             [this](graph_node* node) { retire(node); });
 }
 
 void graph::remove(graph_node* node) {
     auto it = nodes_.find(node);
 
-    if (it != nodes_.end()) {
-        unlink(node);
-        delete node;
-        nodes_.erase(it);
+    if (it != nodes_.end())
+        remove(it);
+}
+
+void graph::drop_column(column_list& columns, attribute_key const& name) {
+    columns.erase(std::remove_if(columns.begin(), columns.end(),
+                                 [&](column_list::value_type const& c) {
+                                     return c.first == name;
+                                 }),
+                  columns.end());
+}
+
+void graph::copy_columns(column_list& to, column_list const& from) {
+    to.reserve(from.size());
+
+    for (auto const& column : from) {
+        to.emplace_back(
+            column.first,
+            std::unique_ptr<detail::column_base>(column.second->clone()));
+    }
+}
+
+void graph::compact(std::vector<graph_node*> const& order) {
+    auto count = nodes_.size();
+
+    if (order.size() != count)
+        throw std::invalid_argument("Order does not cover the graph");
+
+    std::vector<std::uint32_t> from(count);
+    std::vector<std::uint32_t> to(count, node_handle::npos);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        auto node = order[i];
+
+        if (!nodes_.contains(node) || to[node->index()] != node_handle::npos)
+            throw std::invalid_argument("Order does not cover the graph");
+
+        from[i] = static_cast<std::uint32_t>(node->index());
+        to[node->index()] = static_cast<std::uint32_t>(i);
+    }
+
+    // Move the nodes into one block, so that they sit next to each other;
+    // their node data is shared, not cloned. Without an arena the block is
+    // a dedicated one, which replaces the block of the previous compact().
+    std::unique_ptr<arena> block(arena_ ? nullptr : new arena(0));
+    auto storage = static_cast<graph_node*>(
+        (arena_ ? arena_.get() : block.get())->allocate(
+            sizeof(graph_node) * count, alignof(graph_node)));
+
+    std::vector<graph_node*> copies;
+    copies.reserve(count);
+
+    for (auto node : order) {
+        auto copy = new (storage + copies.size()) graph_node(std::move(*node));
+        copy->journal_ = node->journal_;
+        copies.push_back(copy);
+    }
+
+    std::vector<graph_node*> old(nodes_.begin(), nodes_.end());
+    nodes_.reorder(from, copies);
+
+    // Relink between the copies, keeping each link's old index in index_
+    // until the links are sorted in their new order.
+    std::vector<graph_link> links;
+    links.reserve(link_index_.size());
+
+    for (auto link : link_index_) {
+        links.push_back(*link);
+        links.back().source_node = copies[to[link->source_node->index()]];
+        links.back().target_node = copies[to[link->target_node->index()]];
+    }
+
+    std::sort(links.begin(), links.end(),
+              [](graph_link const& a, graph_link const& b) {
+                  return std::make_tuple(a.source_node->index(),
+                                         a.source_socket,
+                                         a.target_node->index(),
+                                         a.target_socket) <
+                         std::make_tuple(b.source_node->index(),
+                                         b.source_socket,
+                                         b.target_node->index(),
+                                         b.target_socket);
+              });
+
+    std::vector<std::uint32_t> link_from;
+    link_from.reserve(links.size());
+
+    for (auto const& link : links)
+        link_from.push_back(link.index_);
+
+    links_.clear();
+    link_index_.clear();
+
+    auto& by_source = links_.get<detail::source_index>();
+
+    for (auto const& link : links) {
+        auto it = by_source.insert(by_source.end(), link);
+        it->index_ = static_cast<std::uint32_t>(link_index_.size());
+        link_index_.push_back(&*it);
     }
+
+    for (auto& column : columns_)
+        column.second->permute(from);
+
+    for (auto& column : link_columns_)
+        column.second->permute(link_from);
+
+    for (auto node : old)
+        dispose(node);
+
+    if (!arena_)
+        block_ = std::move(block);
+}
+
+void graph::retire(graph_node* node) {
+    if (journal_)
+        journal_->record(graph_event::node_removed, node->handle());
+
+    dispose(node);
+}
+
+void graph::dispose(graph_node* node) {
+    if ((arena_ && arena_->owns(node)) || (block_ && block_->owns(node)))
+        node->~graph_node();
+    else
+        delete node;
+}
+
+void graph::release_arena() {
+    // The link container keeps its header and bucket array in the arena as
+    // well: park it on the heap while the arena is released.
+    links_ = detail::link_list();
+    arena_->release();
+    links_ = detail::link_list(arena_.get());
 }
 
 graph_link const& graph::link(graph_link const& link) {
@@ -117,7 +419,14 @@ graph_link const& graph::link(graph_link const& link) {
         link.target_socket >= link.target_node->node()->input_count())
         throw std::out_of_range("Socket index out of range");
 
-    return *links_.insert(link).first;
+    auto result = links_.insert(link);
+
+    if (result.second) {
+        attach(*result.first);
+        record(graph_event::linked, *result.first);
+    }
+
+    return *result.first;
 }
 
 graph_link const& graph::link(graph_node* source_node,
@@ -131,7 +440,15 @@ graph_link const& graph::link(graph_node* source_node,
         target_socket >= target_node->node()->input_count())
         throw std::out_of_range("Socket index out of range");
 
-    return *links_.emplace(source_node, source_socket, target_node, target_socket).first;
+    auto result = links_.emplace(source_node, source_socket,
+                                 target_node, target_socket);
+
+    if (result.second) {
+        attach(*result.first);
+        record(graph_event::linked, *result.first);
+    }
+
+    return *result.first;
 }
 
 void graph::unlink(node_range range) {
@@ -150,23 +467,11 @@ void graph::unlink_outputs(node_range range) {
 }
 
 void graph::unlink_input(graph_node* node, std::size_t socket) {
-    auto range = links_.get<detail::target_index>().equal_range(node);
-    auto it = std::find_if(range.first, range.second,
-                           [socket](graph_link const& link) {
-                               return link.target_socket == socket;
-                           });
-
-    links_.get<detail::target_index>().erase(it);
+    unlink(input_links(node, socket));
 }
 
 void graph::unlink_output(graph_node* node, std::size_t socket) {
-    auto range = links_.get<detail::source_index>().equal_range(node);
-    auto it = std::find_if(range.first, range.second,
-                           [socket](graph_link const& link) {
-                               return link.target_socket == socket;
-                           });
-
-    links_.get<detail::source_index>().erase(it);
+    unlink(output_links(node, socket));
 }
 
 void boost::remove_edge(nodal::graph_node* u,
@@ -0,0 +1,308 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "graph_builder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <tuple>
+
+using namespace nodal;
+
+namespace
+{
+
+auto link_key(frozen_link const& link) {
+    return std::tie(link.source_node, link.source_socket, link.target_node,
+                    link.target_socket);
+}
+
+bool link_less(graph_link const& a, graph_link const& b) {
+    return std::tie(a.source_node, a.source_socket,
+                    a.target_node, a.target_socket) <
+           std::tie(b.source_node, b.source_socket,
+                    b.target_node, b.target_socket);
+}
+
+// Call fn(i) for every i in [0, count) on up to one thread per core.
+// Rethrows the first exception thrown by fn once all calls are done.
+template <typename Fn>
+void parallel_for(std::size_t count, Fn fn) {
+    std::vector<std::exception_ptr> errors(count);
+    std::atomic<std::size_t> next { 0 };
+
+    auto work = [&] {
+        for (std::size_t i; (i = next.fetch_add(1)) < count;) {
+            try {
+                fn(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    auto threads = std::min<std::size_t>(
+        count, std::max(1u, std::thread::hardware_concurrency()));
+
+    std::vector<std::thread> pool;
+
+    for (std::size_t t = 1; t < threads; ++t) {
+        try {
+            pool.emplace_back(work);
+        } catch (std::system_error const&) {
+            break;
+        }
+    }
+
+    work();
+
+    for (auto& thread : pool)
+        thread.join();
+
+    for (auto const& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+} /* namespace */
+
+graph_builder::node_id graph_builder::add(class node const* node) {
+    if (nodes_.size() >= frozen_graph::npos)
+        throw std::length_error("Too many nodes in graph");
+
+    nodes_.push_back(node);
+    return node_id(nodes_.size() - 1);
+}
+
+void graph_builder::link(node_id source_node, std::size_t source_socket,
+                         node_id target_node, std::size_t target_socket) {
+    if (source_socket > std::numeric_limits<frozen_socket>::max() ||
+        target_socket > std::numeric_limits<frozen_socket>::max())
+        throw std::out_of_range("Socket index out of range");
+
+    links_.push_back({ source_node, std::uint32_t(source_socket),
+                       target_node, std::uint32_t(target_socket) });
+}
+
+void graph_builder::validate() const {
+    std::vector<std::pair<std::size_t, std::size_t>> sockets;
+    sockets.reserve(nodes_.size());
+
+    for (auto node : nodes_) {
+        if (node)
+            sockets.emplace_back(node->output_count(), node->input_count());
+        else
+            sockets.emplace_back(0, 0);
+    }
+
+    for (auto const& link : links_) {
+        if (link.source_node >= nodes_.size() ||
+            link.target_node >= nodes_.size())
+            throw std::out_of_range("Node not in graph");
+
+        if (link.source_socket >= sockets[link.source_node].first ||
+            link.target_socket >= sockets[link.target_node].second)
+            throw std::out_of_range("Socket index out of range");
+    }
+}
+
+graph::node_iterator graph_builder::build(graph& graph) {
+    validate();
+    return insert(graph);
+}
+
+std::vector<graph::node_iterator>
+graph_builder::build(graph& graph, std::vector<graph_builder*> const& builders) {
+    auto const count = builders.size();
+
+    parallel_for(count, [&](std::size_t i) { builders[i]->validate(); });
+
+    std::vector<std::size_t> offsets(count);
+    std::size_t total = graph.node_count();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        offsets[i] = total;
+        total += builders[i]->nodes_.size();
+    }
+
+    if (total >= node_handle::npos)
+        throw std::length_error("Too many nodes in graph");
+
+    // Node data is created by each node's data() and may be expensive, so
+    // nodes are constructed in parallel. Arenas are not thread-safe: arena
+    // graphs get their nodes one at a time below.
+    std::vector<std::vector<graph_node*>> created(count);
+
+    if (!graph.uses_arena()) {
+        try {
+            parallel_for(count, [&](std::size_t i) {
+                created[i].reserve(builders[i]->nodes_.size());
+
+                for (auto node : builders[i]->nodes_)
+                    created[i].push_back(new graph_node(node));
+            });
+        } catch (...) {
+            for (auto const& nodes : created) {
+                for (auto node : nodes)
+                    delete node;
+            }
+
+            throw;
+        }
+    }
+
+    graph.nodes_.reserve(total);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (graph.uses_arena()) {
+            for (auto node : builders[i]->nodes_)
+                graph.add(node);
+        } else {
+            for (auto node : created[i])
+                graph.add(node);
+        }
+    }
+
+    std::vector<std::vector<graph_link>> links(count);
+
+    parallel_for(count, [&](std::size_t i) {
+        links[i] = builders[i]->sorted_links(graph.nodes_begin() + offsets[i]);
+    });
+
+    // Merge the sorted runs pairwise, so that the final insertion sees all
+    // links in order.
+    for (std::size_t width = 1; width < count; width *= 2) {
+        parallel_for((count + 2 * width - 1) / (2 * width),
+                     [&](std::size_t j) {
+            auto& a = links[2 * j * width];
+            auto b = 2 * j * width + width;
+
+            if (b >= count)
+                return;
+
+            std::vector<graph_link> merged;
+            merged.reserve(a.size() + links[b].size());
+
+            std::merge(a.begin(), a.end(), links[b].begin(), links[b].end(),
+                       std::back_inserter(merged), link_less);
+
+            a = std::move(merged);
+            links[b] = std::vector<graph_link>();
+        });
+    }
+
+    if (count)
+        insert_links(graph, links[0]);
+
+    std::vector<graph::node_iterator> result;
+    result.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        builders[i]->clear();
+        result.push_back(graph.nodes_begin() + offsets[i]);
+    }
+
+    return result;
+}
+
+graph::node_iterator graph_builder::insert(graph& graph) {
+    auto first = graph.node_count();
+    graph.nodes_.reserve(first + nodes_.size());
+
+    for (auto node : nodes_)
+        graph.add(node);
+
+    insert_links(graph, sorted_links(graph.nodes_begin() + first));
+    clear();
+
+    return graph.nodes_begin() + first;
+}
+
+std::vector<graph_link>
+graph_builder::sorted_links(graph::node_iterator gnodes) const {
+    std::vector<graph_link> links;
+    links.reserve(links_.size());
+
+    for (auto const& link : links_) {
+        links.emplace_back(gnodes[link.source_node], link.source_socket,
+                           gnodes[link.target_node], link.target_socket);
+    }
+
+    std::sort(links.begin(), links.end(), link_less);
+    links.erase(std::unique(links.begin(), links.end()), links.end());
+
+    return links;
+}
+
+void graph_builder::insert_links(graph& graph,
+                                 std::vector<graph_link> const& links) {
+    graph.links_.get<0>().reserve(graph.links_.size() + links.size());
+    graph.link_index_.reserve(graph.link_index_.size() + links.size());
+
+    // Sorted input makes every insertion into the source index land at its
+    // end, where the hint makes it constant time.
+    auto& by_source = graph.links_.get<detail::source_index>();
+    for (auto const& link : links) {
+        auto count = by_source.size();
+        auto it = by_source.insert(by_source.end(), link);
+
+        if (by_source.size() != count) {
+            graph.attach(*it);
+            graph.record(graph_event::linked, link);
+        }
+    }
+}
+
+frozen_graph graph_builder::freeze(graph& graph) {
+    if (graph.node_count() != 0) {
+        build(graph);
+        return graph.freeze();
+    }
+
+    validate();
+
+    std::sort(links_.begin(), links_.end(),
+              [](frozen_link const& a, frozen_link const& b) {
+                  return link_key(a) < link_key(b);
+              });
+
+    links_.erase(std::unique(links_.begin(), links_.end(),
+                             [](frozen_link const& a, frozen_link const& b) {
+                                 return link_key(a) == link_key(b);
+                             }),
+                 links_.end());
+
+    auto links = links_;
+    insert(graph);
+
+    return frozen_graph(
+        std::vector<graph_node*>(graph.nodes_begin(), graph.nodes_end()),
+        std::move(links));
+}
@@ -0,0 +1,422 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "graph_image.hpp"
+
+#include "arena.hpp"
+#include "graph_builder.hpp"
+
+#include "detail/data_encoding.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace nodal;
+
+namespace
+{
+
+using detail::image_alignment;
+using detail::image_byte_order;
+using detail::image_magic;
+using detail::image_serialized_flag;
+using detail::image_writer;
+
+template <frozen_socket frozen_link::*Socket, typename Iterator>
+std::pair<Iterator, Iterator> socket_range(frozen_link const* links,
+                                           std::pair<Iterator, Iterator> range,
+                                           std::uint32_t socket) {
+    auto first = std::lower_bound(
+        range.first, range.second, socket,
+        [links](graph_image::link_id link, std::uint32_t socket) {
+            return links[link].*Socket < socket;
+        });
+
+    auto last = std::upper_bound(
+        first, range.second, socket,
+        [links](std::uint32_t socket, graph_image::link_id link) {
+            return socket < links[link].*Socket;
+        });
+
+    return { first, last };
+}
+
+} /* namespace */
+
+detail::image_header detail::image_header::create(std::uint64_t node_count,
+                                                  std::uint64_t link_count) {
+    image_header h = {};
+    std::copy(std::begin(image_magic), std::end(image_magic), h.magic);
+    h.version = image_version;
+    h.byte_order = image_byte_order;
+    h.link_size = sizeof(frozen_link);
+    h.node_count = node_count;
+    h.link_count = link_count;
+
+    return h;
+}
+
+bool detail::image_header::valid(std::uint64_t file_size) const {
+    auto n = node_count;
+    auto m = link_count;
+
+    // Each section must lie within the file, after the previous one.
+    auto in_bounds = [this, file_size](std::uint64_t offset,
+                                       std::uint64_t next) {
+        return offset % image_alignment == 0 && offset <= next &&
+               next <= size && size <= file_size;
+    };
+
+    return std::equal(std::begin(image_magic), std::end(image_magic),
+                      magic) &&
+           version == image_version && byte_order == image_byte_order &&
+           link_size == sizeof(frozen_link) && n < frozen_graph::npos &&
+           m < frozen_graph::npos && types >= sizeof(image_header) &&
+           in_bounds(types, types + n * 4) &&
+           types + n * 4 <= output_offsets &&
+           in_bounds(output_offsets, output_offsets + (n + 1) * 4) &&
+           output_offsets + (n + 1) * 4 <= links &&
+           in_bounds(links, links + m * sizeof(frozen_link)) &&
+           links + m * sizeof(frozen_link) <= input_offsets &&
+           in_bounds(input_offsets, input_offsets + (n + 1) * 4) &&
+           input_offsets + (n + 1) * 4 <= input_index &&
+           in_bounds(input_index, input_index + m * 4) &&
+           input_index + m * 4 <= data_offsets &&
+           in_bounds(data_offsets, data_offsets + n * 8) &&
+           data_offsets + n * 8 <= data_sizes &&
+           in_bounds(data_sizes, data_sizes + n * 4) &&
+           data_sizes + n * 4 <= data && in_bounds(data, size);
+}
+
+void graph_image::write(std::string const& path, graph const& graph,
+                        std::vector<class node const*> const& types) {
+    std::unordered_map<class node const*, std::uint32_t> type_ids;
+    type_ids.reserve(types.size());
+
+    for (std::size_t i = 0; i < types.size(); ++i)
+        type_ids.emplace(types[i], std::uint32_t(i));
+
+    auto frozen = graph.freeze();
+    auto node_count = frozen.node_count();
+
+    std::vector<std::uint32_t> type_table(node_count);
+    std::vector<std::uint64_t> data_offsets(node_count, 0);
+    std::vector<std::uint32_t> data_sizes(node_count, 0);
+    std::vector<std::uint8_t> serialized;
+    std::uint64_t data_size = 0;
+
+    for (node_id n = 0; n < node_count; ++n) {
+        graph_node const* gnode = frozen.node(n);
+        auto type = type_ids.find(gnode->node());
+
+        if (type == type_ids.end())
+            throw std::invalid_argument("Node type not in type table");
+
+        type_table[n] = type->second;
+
+        auto data = gnode->data();
+        auto typed = dynamic_cast<typed_node const*>(gnode->node());
+        std::size_t size = 0;
+        std::uint32_t flags = 0;
+
+        if (data && data->raw_size()) {
+            size = data->raw_size();
+        } else if (data && typed) {
+            auto start = serialized.size();
+            typed->serialize_data(data, serialized);
+
+            size = serialized.size() - start;
+            flags = image_serialized_flag;
+        }
+
+        if (size >= image_serialized_flag)
+            throw std::length_error("Node data too large for graph image");
+
+        data_offsets[n] = data_size;
+        data_sizes[n] = std::uint32_t(size) | flags;
+        data_size = detail::image_align(data_size + size);
+    }
+
+    std::vector<std::uint32_t> output_offsets(node_count + 1, 0);
+    std::vector<std::uint32_t> input_offsets(node_count + 1, 0);
+
+    for (node_id n = 0; n < node_count; ++n) {
+        output_offsets[n + 1] =
+            output_offsets[n] + std::uint32_t(frozen.output_degree(n));
+        input_offsets[n + 1] =
+            input_offsets[n] + std::uint32_t(frozen.input_degree(n));
+    }
+
+    std::vector<frozen_link> links;
+    links.reserve(frozen.link_count());
+
+    for (link_id l = 0; l < frozen.link_count(); ++l)
+        links.push_back(frozen.link(l));
+
+    std::vector<link_id> input_index;
+    input_index.reserve(links.size());
+
+    for (node_id n = 0; n < node_count; ++n) {
+        auto range = frozen.input_links(n);
+        input_index.insert(input_index.end(), range.first, range.second);
+    }
+
+    auto h = detail::image_header::create(node_count, links.size());
+
+    image_writer out(path);
+    out.write(&h, sizeof(h));
+
+    h.types = out.section(type_table);
+    h.output_offsets = out.section(output_offsets);
+    h.links = out.section(links);
+    h.input_offsets = out.section(input_offsets);
+    h.input_index = out.section(input_index);
+    h.data_offsets = out.section(data_offsets);
+    h.data_sizes = out.section(data_sizes);
+    h.data = out.begin_section();
+
+    // Serialized blocks were appended in node order.
+    auto next = serialized.data();
+
+    for (node_id n = 0; n < node_count; ++n) {
+        auto size = data_sizes[n] & ~image_serialized_flag;
+
+        if (!size)
+            continue;
+
+        out.begin_section();
+
+        if (data_sizes[n] & image_serialized_flag) {
+            out.write(next, size);
+            next += size;
+        } else {
+            graph_node const* gnode = frozen.node(n);
+            out.write(gnode->data()->raw_data(), size);
+        }
+    }
+
+    out.begin_section();
+    h.size = out.offset();
+
+    out.finish(h);
+}
+
+graph_image::graph_image(std::string const& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), path);
+
+    struct stat st;
+
+    if (::fstat(fd, &st) < 0) {
+        auto error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+
+    if (std::size_t(st.st_size) < sizeof(detail::image_header)) {
+        ::close(fd);
+        throw std::invalid_argument("Not a graph image");
+    }
+
+    auto map = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ,
+                      MAP_PRIVATE, fd, 0);
+    auto error = errno;
+    ::close(fd);
+
+    if (map == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(), path);
+
+    header_ = static_cast<detail::image_header const*>(map);
+    size_ = std::size_t(st.st_size);
+
+    if (!header_->valid(size_)) {
+        unmap();
+        throw std::invalid_argument("Not a graph image");
+    }
+
+    auto const& h = *header_;
+    auto base = static_cast<unsigned char const*>(map);
+
+    node_count_ = std::size_t(h.node_count);
+    link_count_ = std::size_t(h.link_count);
+
+    types_ = reinterpret_cast<std::uint32_t const*>(base + h.types);
+    output_offsets_ =
+        reinterpret_cast<std::uint32_t const*>(base + h.output_offsets);
+    links_ = reinterpret_cast<frozen_link const*>(base + h.links);
+    input_offsets_ =
+        reinterpret_cast<std::uint32_t const*>(base + h.input_offsets);
+    input_index_ = reinterpret_cast<link_id const*>(base + h.input_index);
+    data_offsets_ =
+        reinterpret_cast<std::uint64_t const*>(base + h.data_offsets);
+    data_sizes_ = reinterpret_cast<std::uint32_t const*>(base + h.data_sizes);
+    data_ = base + h.data;
+}
+
+graph_image::graph_image(graph_image&& other) {
+    swap(other);
+}
+
+graph_image& graph_image::operator=(graph_image&& other) {
+    graph_image(std::move(other)).swap(*this);
+    return *this;
+}
+
+graph_image::~graph_image() {
+    unmap();
+}
+
+void graph_image::swap(graph_image& other) {
+    std::swap(header_, other.header_);
+    std::swap(size_, other.size_);
+    std::swap(node_count_, other.node_count_);
+    std::swap(link_count_, other.link_count_);
+    std::swap(types_, other.types_);
+    std::swap(output_offsets_, other.output_offsets_);
+    std::swap(links_, other.links_);
+    std::swap(input_offsets_, other.input_offsets_);
+    std::swap(input_index_, other.input_index_);
+    std::swap(data_offsets_, other.data_offsets_);
+    std::swap(data_sizes_, other.data_sizes_);
+    std::swap(data_, other.data_);
+}
+
+void graph_image::unmap() {
+    if (header_)
+        ::munmap(const_cast<detail::image_header*>(header_), size_);
+
+    header_ = nullptr;
+    size_ = node_count_ = link_count_ = 0;
+}
+
+graph_image::input_link_range
+graph_image::input_links(node_id node, std::uint32_t socket) const {
+    return socket_range<&frozen_link::target_socket>(links_,
+                                                     input_links(node),
+                                                     socket);
+}
+
+graph_image::output_link_range
+graph_image::output_links(node_id node, std::uint32_t socket) const {
+    return socket_range<&frozen_link::source_socket>(links_,
+                                                     output_links(node),
+                                                     socket);
+}
+
+graph::node_iterator
+graph_image::load(graph& graph,
+                  std::vector<class node const*> const& types) const {
+    auto data_size = header_->size - header_->data;
+
+    auto load_data = [this](node_id n, class node const* type,
+                            node_data* target) {
+        auto block = data(n);
+        auto encoding = data_serialized(n) ? detail::data_encoding::serialized
+                                           : detail::data_encoding::raw;
+
+        detail::decode_data(type, target, encoding,
+                            static_cast<std::uint8_t const*>(block.first),
+                            block.second);
+    };
+
+    graph_builder builder;
+    builder.reserve(node_count_, link_count_);
+
+    // Check every data block against scratch data of its node type before
+    // the graph is touched, so that a bad image leaves it unchanged.
+    std::vector<std::unique_ptr<node_data>> scratch(types.size());
+
+    {
+        arena::scope scope(nullptr);
+
+        for (node_id n = 0; n < node_count_; ++n) {
+            if (types_[n] >= types.size())
+                throw std::out_of_range("Node type id out of range");
+
+            auto type = types[types_[n]];
+            builder.add(type);
+
+            std::uint64_t size = data_sizes_[n] & ~image_serialized_flag;
+
+            if (!size)
+                continue;
+
+            if (size > data_size || data_offsets_[n] > data_size - size)
+                throw std::invalid_argument("Node data outside graph image");
+
+            auto& sample = scratch[types_[n]];
+
+            if (!sample && type)
+                sample.reset(type->data());
+
+            load_data(n, type, sample.get());
+        }
+    }
+
+    scratch.clear();
+
+    for (link_id l = 0; l < link_count_; ++l) {
+        auto const& link = links_[l];
+        builder.link(link.source_node, link.source_socket,
+                     link.target_node, link.target_socket);
+    }
+
+    auto first = builder.build(graph);
+    auto it = first;
+
+    for (node_id n = 0; n < node_count_; ++n, ++it) {
+        if (data_sizes_[n] & ~image_serialized_flag)
+            load_data(n, (*it)->node(), (*it)->data());
+    }
+
+    return first;
+}
+
+mapped_graph::mapped_graph(std::string const& path,
+                           std::vector<class node const*> types)
+    : image_(path), types_(std::move(types))
+    {}
+
+graph& mapped_graph::edit() {
+    if (!graph_) {
+        std::unique_ptr<graph> loaded(new graph);
+        image_.load(*loaded, types_);
+        graph_ = std::move(loaded);
+    }
+
+    return *graph_;
+}
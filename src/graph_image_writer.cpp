@@ -0,0 +1,428 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "graph_image_writer.hpp"
+
+#include "detail/data_encoding.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+
+using namespace nodal;
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    // Temporary file written once and then read back, possibly several
+    // times. The file is removed with the spool.
+    class image_spool {
+    public:
+        explicit image_spool(std::string path)
+            : path(std::move(path)),
+              file(this->path, std::ios::in | std::ios::out |
+                                   std::ios::binary | std::ios::trunc)
+        {
+            if (!file)
+                throw std::system_error(errno, std::generic_category(),
+                                        this->path);
+        }
+
+        ~image_spool() {
+            file.close();
+            std::remove(path.c_str());
+        }
+
+        image_spool(image_spool const&) = delete;
+        image_spool& operator=(image_spool const&) = delete;
+
+        std::uint64_t size() const {
+            return size_;
+        }
+
+        void write(void const* data, std::size_t size) {
+            file.write(static_cast<char const*>(data), std::streamsize(size));
+            size_ += size;
+
+            if (!file)
+                throw std::system_error(errno, std::generic_category(), path);
+        }
+
+        void rewind() {
+            file.flush();
+            file.clear();
+            file.seekg(0);
+        }
+
+        // Read up to size bytes, returning how many were read.
+        std::size_t read(void* out, std::size_t size) {
+            file.read(static_cast<char*>(out), std::streamsize(size));
+
+            if (file.bad())
+                throw std::system_error(errno, std::generic_category(), path);
+
+            auto count = std::size_t(file.gcount());
+
+            if (count < size)
+                file.clear();
+
+            return count;
+        }
+
+    private:
+        std::string path;
+        std::fstream file;
+        std::uint64_t size_ = 0;
+    };
+
+} /* namespace detail */
+
+} /* namespace nodal */
+
+namespace
+{
+
+using detail::image_serialized_flag;
+
+// Records read from a spool at a time.
+constexpr std::size_t scan_size = 1 << 14;
+
+// Call fn(index, record) for every record in spool, in order.
+template <typename T, typename Fn>
+void scan(detail::image_spool& spool, Fn fn) {
+    std::vector<T> buffer(scan_size);
+    std::uint32_t index = 0;
+
+    spool.rewind();
+
+    for (std::size_t count;
+         (count = spool.read(buffer.data(), scan_size * sizeof(T)) /
+                  sizeof(T));) {
+        for (std::size_t i = 0; i < count; ++i)
+            fn(index++, buffer[i]);
+    }
+}
+
+// Split the nodes into consecutive ranges holding at most limit items each
+// according to offsets, except for single nodes holding more. Returns the
+// range bounds, from 0 to the node count.
+std::vector<std::uint32_t> split(std::vector<std::uint32_t> const& offsets,
+                                 std::size_t limit) {
+    std::vector<std::uint32_t> bounds(1, 0);
+    auto count = std::uint32_t(offsets.size() - 1);
+
+    for (std::uint32_t n = 0; n < count; ++n) {
+        auto first = bounds.back();
+
+        if (n > first && offsets[n + 1] - offsets[first] > limit)
+            bounds.push_back(n);
+    }
+
+    if (count)
+        bounds.push_back(count);
+
+    return bounds;
+}
+
+void copy_spool(detail::image_spool& spool, detail::image_writer& out) {
+    std::vector<char> buffer(std::size_t(1) << 20);
+    spool.rewind();
+
+    for (std::size_t count; (count = spool.read(buffer.data(), buffer.size()));)
+        out.write(buffer.data(), count);
+}
+
+} /* namespace */
+
+graph_image_writer::graph_image_writer(std::string path,
+                                       std::vector<class node const*> types,
+                                       std::size_t memory_size)
+    : path(std::move(path)), types(std::move(types)),
+      memory_size(memory_size),
+      link_spool(new detail::image_spool(this->path + ".links.tmp")),
+      data_spool(new detail::image_spool(this->path + ".data.tmp"))
+{
+    type_ids.reserve(this->types.size());
+
+    for (std::size_t i = 0; i < this->types.size(); ++i)
+        type_ids.emplace(this->types[i], std::uint32_t(i));
+}
+
+graph_image_writer::~graph_image_writer() = default;
+
+graph_image_writer::node_id
+graph_image_writer::add(class node const* node, node_data const* data) {
+    check_open();
+
+    if (node_types.size() >= graph_image::npos)
+        throw std::length_error("Too many nodes in graph");
+
+    auto id = node_id(node_types.size());
+
+    node_types.push_back(graph_image::npos);
+    output_degrees.push_back(0);
+    data_offsets.push_back(0);
+    data_sizes.push_back(0);
+
+    if (node)
+        assign(id, node, data);
+
+    return id;
+}
+
+void graph_image_writer::assign(node_id id, class node const* node,
+                                node_data const* data) {
+    check_open();
+
+    if (id >= node_types.size())
+        throw std::out_of_range("Node not in graph");
+
+    auto type = type_ids.find(node);
+
+    if (type == type_ids.end())
+        throw std::invalid_argument("Node type not in type table");
+
+    node_types[id] = type->second;
+
+    if (data)
+        store(id, node, data);
+}
+
+void graph_image_writer::link(node_id source_node, std::size_t source_socket,
+                              node_id target_node,
+                              std::size_t target_socket) {
+    check_open();
+
+    if (source_node >= node_types.size() || target_node >= node_types.size())
+        throw std::out_of_range("Node not in graph");
+
+    if (source_socket > std::numeric_limits<frozen_socket>::max() ||
+        target_socket > std::numeric_limits<frozen_socket>::max())
+        throw std::out_of_range("Socket index out of range");
+
+    if (spooled_links >= graph_image::npos)
+        throw std::length_error("Too many links in graph");
+
+    frozen_link link(source_node, std::uint32_t(source_socket),
+                     target_node, std::uint32_t(target_socket));
+
+    link_spool->write(&link, sizeof(link));
+    ++output_degrees[source_node];
+    ++spooled_links;
+}
+
+void graph_image_writer::finish() {
+    check_open();
+
+    auto const node_count = node_types.size();
+
+    for (std::size_t n = 0; n < node_count; ++n) {
+        if (node_types[n] == graph_image::npos)
+            throw std::invalid_argument("Undefined node " + std::to_string(n));
+    }
+
+    std::vector<std::pair<std::size_t, std::size_t>> sockets;
+    sockets.reserve(types.size());
+
+    for (auto type : types) {
+        if (type)
+            sockets.emplace_back(type->output_count(), type->input_count());
+        else
+            sockets.emplace_back(0, 0);
+    }
+
+    // Sort the links by source in batches of source nodes that fit in
+    // memory_size, dropping duplicates, and count the links that remain.
+    std::vector<std::uint32_t> output_offsets(node_count + 1, 0);
+    std::vector<std::uint32_t> input_offsets(node_count + 1, 0);
+
+    std::partial_sum(output_degrees.begin(), output_degrees.end(),
+                     output_offsets.begin() + 1);
+    std::vector<std::uint32_t>().swap(output_degrees);
+
+    auto bounds = split(output_offsets,
+                        std::max<std::size_t>(memory_size /
+                                              sizeof(frozen_link), 1));
+
+    std::fill(output_offsets.begin(), output_offsets.end(), 0);
+
+    detail::image_spool sorted(path + ".sorted.tmp");
+    std::vector<frozen_link> batch;
+
+    for (std::size_t r = 0; r + 1 < bounds.size(); ++r) {
+        auto first = bounds[r];
+        auto last = bounds[r + 1];
+
+        batch.clear();
+
+        scan<frozen_link>(*link_spool, [&](std::uint32_t,
+                                           frozen_link const& link) {
+            if (link.source_node < first || link.source_node >= last)
+                return;
+
+            if (link.source_socket >=
+                    sockets[node_types[link.source_node]].first ||
+                link.target_socket >=
+                    sockets[node_types[link.target_node]].second)
+                throw std::out_of_range("Socket index out of range");
+
+            batch.push_back(link);
+        });
+
+        auto key = [](frozen_link const& link) {
+            return std::make_tuple(link.source_node, link.source_socket,
+                                   link.target_node, link.target_socket);
+        };
+
+        std::sort(batch.begin(), batch.end(),
+                  [&key](frozen_link const& a, frozen_link const& b) {
+                      return key(a) < key(b);
+                  });
+
+        batch.erase(std::unique(batch.begin(), batch.end(),
+                                [&key](frozen_link const& a,
+                                       frozen_link const& b) {
+                                    return key(a) == key(b);
+                                }),
+                    batch.end());
+
+        for (auto const& link : batch) {
+            ++output_offsets[link.source_node + 1];
+            ++input_offsets[link.target_node + 1];
+        }
+
+        sorted.write(batch.data(), batch.size() * sizeof(frozen_link));
+    }
+
+    std::vector<frozen_link>().swap(batch);
+    link_spool.reset();
+
+    std::partial_sum(output_offsets.begin(), output_offsets.end(),
+                     output_offsets.begin());
+    std::partial_sum(input_offsets.begin(), input_offsets.end(),
+                     input_offsets.begin());
+
+    auto const link_count = output_offsets.back();
+    auto h = detail::image_header::create(node_count, link_count);
+
+    detail::image_writer out(path);
+    out.write(&h, sizeof(h));
+
+    h.types = out.section(node_types);
+    h.output_offsets = out.section(output_offsets);
+    h.links = out.begin_section();
+    copy_spool(sorted, out);
+    h.input_offsets = out.section(input_offsets);
+    h.input_index = out.begin_section();
+
+    // Order links by target in batches of target nodes, the way
+    // frozen_graph orders its input index.
+    struct input_entry {
+        std::uint32_t target;
+        std::uint32_t socket;
+        std::uint32_t link;
+    };
+
+    bounds = split(input_offsets,
+                   std::max<std::size_t>(memory_size / sizeof(input_entry),
+                                         1));
+
+    std::vector<input_entry> entries;
+    std::vector<std::uint32_t> index;
+
+    for (std::size_t r = 0; r + 1 < bounds.size(); ++r) {
+        auto first = bounds[r];
+        auto last = bounds[r + 1];
+
+        entries.clear();
+
+        scan<frozen_link>(sorted, [&](std::uint32_t id,
+                                      frozen_link const& link) {
+            if (link.target_node >= first && link.target_node < last)
+                entries.push_back({ link.target_node, link.target_socket,
+                                    id });
+        });
+
+        std::sort(entries.begin(), entries.end(),
+                  [](input_entry const& a, input_entry const& b) {
+                      return std::tie(a.target, a.socket, a.link) <
+                             std::tie(b.target, b.socket, b.link);
+                  });
+
+        index.clear();
+
+        for (auto const& entry : entries)
+            index.push_back(entry.link);
+
+        out.write(index.data(), index.size() * sizeof(std::uint32_t));
+    }
+
+    h.data_offsets = out.section(data_offsets);
+    h.data_sizes = out.section(data_sizes);
+    h.data = out.begin_section();
+    copy_spool(*data_spool, out);
+
+    out.begin_section();
+    h.size = out.offset();
+
+    out.finish(h);
+    data_spool.reset();
+}
+
+void graph_image_writer::store(node_id id, class node const* node,
+                               node_data const* data) {
+    static char const zeros[detail::image_alignment] = {};
+
+    block.clear();
+    auto encoding = detail::encode_data(node, data, block);
+
+    if (block.size() >= image_serialized_flag)
+        throw std::length_error("Node data too large for graph image");
+
+    auto size = std::uint32_t(block.size());
+
+    if (!size)
+        return;
+
+    data_offsets[id] = data_spool->size();
+    data_sizes[id] = size | (encoding == detail::data_encoding::serialized
+                                 ? image_serialized_flag
+                                 : 0);
+
+    data_spool->write(block.data(), size);
+    data_spool->write(zeros, detail::image_align(size) - size);
+}
+
+void graph_image_writer::check_open() const {
+    if (!data_spool)
+        throw std::logic_error("Graph image already written");
+}
@@ -0,0 +1,655 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "graph_importer.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+#include <unistd.h>
+
+using namespace nodal;
+
+namespace
+{
+
+constexpr std::size_t read_chunk_size = 1 << 16;
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool parse_uint(char const* first, char const* last, std::uint64_t& value) {
+    if (first == last || last - first > 19)
+        return false;
+
+    value = 0;
+
+    for (; first != last; ++first) {
+        if (*first < '0' || *first > '9')
+            return false;
+
+        value = value * 10 + std::uint64_t(*first - '0');
+    }
+
+    return true;
+}
+
+void append_utf8(std::string& out, std::uint32_t code) {
+    if (code < 0x80) {
+        out += char(code);
+    } else if (code < 0x800) {
+        out += char(0xc0 | (code >> 6));
+        out += char(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+        out += char(0xe0 | (code >> 12));
+        out += char(0x80 | ((code >> 6) & 0x3f));
+        out += char(0x80 | (code & 0x3f));
+    } else {
+        out += char(0xf0 | (code >> 18));
+        out += char(0x80 | ((code >> 12) & 0x3f));
+        out += char(0x80 | ((code >> 6) & 0x3f));
+        out += char(0x80 | (code & 0x3f));
+    }
+}
+
+// Just enough JSON to read one flat object per line. Every method returns
+// false on malformed input.
+class json_reader {
+public:
+    json_reader(char const* first, char const* last)
+        : pos(first), end(last)
+        {}
+
+    bool at_end() {
+        skip_space();
+        return pos == end;
+    }
+
+    bool consume(char c) {
+        skip_space();
+
+        if (pos == end || *pos != c)
+            return false;
+
+        ++pos;
+        return true;
+    }
+
+    bool peek(char c) {
+        skip_space();
+        return pos != end && *pos == c;
+    }
+
+    bool string(std::string& out) {
+        if (!consume('"'))
+            return false;
+
+        out.clear();
+
+        while (pos != end && *pos != '"') {
+            if (*pos != '\\') {
+                out += *pos++;
+                continue;
+            }
+
+            if (++pos == end)
+                return false;
+
+            switch (*pos++) {
+            case '"':  out += '"';  break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/';  break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                std::uint32_t code;
+
+                if (!hex4(code))
+                    return false;
+
+                // Combine surrogate pairs.
+                if (code >= 0xd800 && code < 0xdc00 && end - pos >= 6 &&
+                    pos[0] == '\\' && pos[1] == 'u') {
+                    pos += 2;
+                    std::uint32_t low;
+
+                    if (!hex4(low) || low < 0xdc00 || low >= 0xe000)
+                        return false;
+
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                }
+
+                append_utf8(out, code);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+
+        if (pos == end)
+            return false;
+
+        ++pos;
+        return true;
+    }
+
+    // Characters of a number token, left for the caller to interpret.
+    bool number(char const*& first, char const*& last) {
+        skip_space();
+        first = pos;
+
+        while (pos != end && (std::isdigit(static_cast<unsigned char>(*pos)) ||
+                              *pos == '-' || *pos == '+' || *pos == '.' ||
+                              *pos == 'e' || *pos == 'E'))
+            ++pos;
+
+        last = pos;
+        return first != last;
+    }
+
+    bool skip_value() {
+        skip_space();
+
+        if (pos == end)
+            return false;
+
+        std::string scratch;
+        char const* first;
+        char const* last;
+
+        switch (*pos) {
+        case '"':
+            return string(scratch);
+        case '{':
+            return skip_container('{', '}', true);
+        case '[':
+            return skip_container('[', ']', false);
+        case 't':
+            return literal("true");
+        case 'f':
+            return literal("false");
+        case 'n':
+            return literal("null");
+        default:
+            return number(first, last);
+        }
+    }
+
+private:
+    void skip_space() {
+        while (pos != end && is_space(*pos))
+            ++pos;
+    }
+
+    bool hex4(std::uint32_t& code) {
+        if (end - pos < 4)
+            return false;
+
+        code = 0;
+
+        for (int i = 0; i < 4; ++i, ++pos) {
+            char c = *pos;
+            code <<= 4;
+
+            if (c >= '0' && c <= '9')
+                code |= std::uint32_t(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                code |= std::uint32_t(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                code |= std::uint32_t(c - 'A' + 10);
+            else
+                return false;
+        }
+
+        return true;
+    }
+
+    bool literal(char const* word) {
+        auto length = std::strlen(word);
+
+        if (std::size_t(end - pos) < length ||
+            std::memcmp(pos, word, length) != 0)
+            return false;
+
+        pos += length;
+        return true;
+    }
+
+    bool skip_container(char open, char close, bool keys) {
+        consume(open);
+
+        if (consume(close))
+            return true;
+
+        std::string key;
+
+        do {
+            if (keys && (!string(key) || !consume(':')))
+                return false;
+
+            if (!skip_value())
+                return false;
+        } while (consume(','));
+
+        return consume(close);
+    }
+
+    char const* pos;
+    char const* end;
+};
+
+} /* namespace */
+
+graph_importer::graph_importer(
+    format_t format, std::unordered_map<std::string, class node const*> types)
+    : format(format), types(std::move(types))
+    {}
+
+graph_importer::graph_importer(
+    format_t format, std::unordered_map<std::string, class node const*> types,
+    graph_image_writer& writer)
+    : format(format), types(std::move(types)), writer(&writer)
+    {}
+
+void graph_importer::feed(char const* data, std::size_t size) {
+    auto end = data + size;
+
+    while (data != end) {
+        auto newline = static_cast<char const*>(
+            std::memchr(data, '\n', std::size_t(end - data)));
+
+        if (!newline) {
+            partial.append(data, end);
+            break;
+        }
+
+        if (partial.empty()) {
+            parse_line(data, newline);
+        } else {
+            partial.append(data, newline);
+            parse_line(partial.data(), partial.data() + partial.size());
+            partial.clear();
+        }
+
+        data = newline + 1;
+    }
+}
+
+void graph_importer::read(int fd) {
+    std::unique_ptr<char[]> buffer(new char[read_chunk_size]);
+
+    for (;;) {
+        auto count = ::read(fd, buffer.get(), read_chunk_size);
+
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+
+            throw std::system_error(errno, std::generic_category(),
+                                    "graph_importer::read");
+        }
+
+        if (count == 0)
+            break;
+
+        feed(buffer.get(), std::size_t(count));
+    }
+
+    finish();
+}
+
+void graph_importer::finish() {
+    if (partial.empty())
+        return;
+
+    std::string last;
+    last.swap(partial);
+    parse_line(last.data(), last.data() + last.size());
+}
+
+graph_importer::node_id graph_importer::find(std::string const& id) const {
+    std::uint64_t value;
+
+    if (parse_uint(id.data(), id.data() + id.size(), value)) {
+        if (value < dense_ids.size())
+            return dense_ids[std::size_t(value)];
+
+        auto it = sparse_ids.find(value);
+        return (it != sparse_ids.end()) ? it->second : frozen_graph::npos;
+    }
+
+    auto it = named_ids.find(id);
+    return (it != named_ids.end()) ? it->second : frozen_graph::npos;
+}
+
+graph::node_iterator graph_importer::build(graph& graph) {
+    if (writer)
+        throw std::logic_error("Importer writes to a graph image");
+
+    check_defined();
+
+    // Drop the id tables before the graph grows.
+    reset();
+    return builder.build(graph);
+}
+
+void graph_importer::write() {
+    if (!writer)
+        throw std::logic_error("Importer has no graph image writer");
+
+    check_defined();
+    reset();
+    writer->finish();
+}
+
+void graph_importer::check_defined() const {
+    auto undefined = std::find(defined.begin(), defined.end(), false);
+
+    if (undefined == defined.end())
+        return;
+
+    auto id = node_id(undefined - defined.begin());
+    auto dense = std::find(dense_ids.begin(), dense_ids.end(), id);
+
+    if (dense != dense_ids.end())
+        throw std::invalid_argument(
+            "Undefined node " + std::to_string(dense - dense_ids.begin()));
+
+    for (auto const& entry : sparse_ids) {
+        if (entry.second == id)
+            throw std::invalid_argument("Undefined node " +
+                                        std::to_string(entry.first));
+    }
+
+    auto named = std::find_if(
+        named_ids.begin(), named_ids.end(),
+        [id](std::pair<std::string const, node_id> const& entry) {
+            return entry.second == id;
+        });
+
+    throw std::invalid_argument("Undefined node " + named->first);
+}
+
+void graph_importer::reset() {
+    std::vector<bool>().swap(defined);
+    std::vector<node_id>().swap(dense_ids);
+    std::unordered_map<std::uint64_t, node_id>().swap(sparse_ids);
+    std::unordered_map<std::string, node_id>().swap(named_ids);
+    line = 0;
+}
+
+void graph_importer::parse_line(char const* first, char const* last) {
+    ++line;
+
+    while (first != last && is_space(*first))
+        ++first;
+
+    while (first != last && is_space(last[-1]))
+        --last;
+
+    if (first == last)
+        return;
+
+    if (format == json_lines)
+        parse_json(first, last);
+    else
+        parse_record(first, last);
+}
+
+void graph_importer::parse_record(char const* first, char const* last) {
+    if (*first == '#')
+        return;
+
+    std::pair<char const*, char const*> tokens[6];
+    std::size_t count = 0;
+
+    while (first != last) {
+        if (count == 6)
+            throw error("Too many fields");
+
+        auto start = first;
+
+        while (first != last && !is_space(*first))
+            ++first;
+
+        tokens[count++] = { start, first };
+
+        while (first != last && is_space(*first))
+            ++first;
+    }
+
+    auto keyword = std::string(tokens[0].first, tokens[0].second);
+
+    if (keyword == "node") {
+        if (count != 3)
+            throw error("Expected: node <id> <type>");
+
+        define(tokens[1].first, tokens[1].second,
+               std::string(tokens[2].first, tokens[2].second));
+    } else if (keyword == "link") {
+        std::uint64_t source_socket, target_socket;
+
+        if (count != 5 ||
+            !parse_uint(tokens[2].first, tokens[2].second, source_socket) ||
+            !parse_uint(tokens[4].first, tokens[4].second, target_socket))
+            throw error("Expected: link <id> <socket> <id> <socket>");
+
+        auto source = resolve(tokens[1].first, tokens[1].second);
+        auto target = resolve(tokens[3].first, tokens[3].second);
+
+        link(source, source_socket, target, target_socket);
+    } else {
+        throw error("Unknown record " + keyword);
+    }
+}
+
+void graph_importer::parse_json(char const* first, char const* last) {
+    json_reader reader(first, last);
+
+    std::string node, type, source, target, key;
+    std::uint64_t source_socket = 0, target_socket = 0;
+    bool has_node = false, has_type = false, has_source = false,
+         has_target = false, has_source_socket = false,
+         has_target_socket = false;
+
+    // Ids may be strings or unsigned integers.
+    auto read_id = [&reader](std::string& id) {
+        if (reader.peek('"'))
+            return reader.string(id);
+
+        char const* first;
+        char const* last;
+        std::uint64_t value;
+
+        if (!reader.number(first, last) || !parse_uint(first, last, value))
+            return false;
+
+        id.assign(first, last);
+        return true;
+    };
+
+    auto read_socket = [&reader](std::uint64_t& socket) {
+        char const* first;
+        char const* last;
+
+        return reader.number(first, last) && parse_uint(first, last, socket);
+    };
+
+    bool valid = reader.consume('{');
+
+    if (valid && !reader.consume('}')) {
+        do {
+            if (!reader.string(key) || !reader.consume(':')) {
+                valid = false;
+            } else if (key == "node") {
+                valid = has_node = read_id(node);
+            } else if (key == "type") {
+                valid = has_type = reader.string(type);
+            } else if (key == "source") {
+                valid = has_source = read_id(source);
+            } else if (key == "target") {
+                valid = has_target = read_id(target);
+            } else if (key == "source_socket") {
+                valid = has_source_socket = read_socket(source_socket);
+            } else if (key == "target_socket") {
+                valid = has_target_socket = read_socket(target_socket);
+            } else {
+                valid = reader.skip_value();
+            }
+        } while (valid && reader.consume(','));
+
+        valid = valid && reader.consume('}');
+    }
+
+    if (!valid || !reader.at_end())
+        throw error("Malformed JSON record");
+
+    bool is_link = has_source || has_target || has_source_socket ||
+                   has_target_socket;
+
+    if (has_node && !is_link) {
+        if (!has_type)
+            throw error("Node record without type");
+
+        define(node.data(), node.data() + node.size(), type);
+    } else if (is_link && !has_node) {
+        if (!has_source || !has_target || !has_source_socket ||
+            !has_target_socket)
+            throw error("Incomplete link record");
+
+        auto source_id = resolve(source.data(), source.data() + source.size());
+        auto target_id = resolve(target.data(), target.data() + target.size());
+
+        link(source_id, source_socket, target_id, target_socket);
+    } else {
+        throw error("Record is neither a node nor a link");
+    }
+}
+
+void graph_importer::define(char const* first, char const* last,
+                            std::string const& type) {
+    auto it = types.find(type);
+
+    if (it == types.end())
+        throw error("Unknown node type " + type);
+
+    auto id = resolve(first, last);
+
+    if (defined[id])
+        throw error("Node " + std::string(first, last) + " defined twice");
+
+    if (writer)
+        writer->assign(id, it->second);
+    else
+        builder.assign(id, it->second);
+
+    defined[id] = true;
+}
+
+void graph_importer::link(node_id source, std::uint64_t source_socket,
+                          node_id target, std::uint64_t target_socket) {
+    try {
+        if (writer)
+            writer->link(source, std::size_t(source_socket),
+                         target, std::size_t(target_socket));
+        else
+            builder.link(source, std::size_t(source_socket),
+                         target, std::size_t(target_socket));
+    } catch (std::out_of_range const& e) {
+        throw error(e.what());
+    }
+}
+
+graph_importer::node_id graph_importer::resolve(char const* first,
+                                                char const* last) {
+    std::uint64_t value;
+    node_id* slot;
+
+    if (parse_uint(first, last, value)) {
+        slot = &integer_slot(value);
+    } else {
+        slot = &named_ids.emplace(std::string(first, last),
+                                  frozen_graph::npos).first->second;
+    }
+
+    if (*slot == frozen_graph::npos) {
+        *slot = writer ? writer->add(nullptr) : builder.add(nullptr);
+        defined.push_back(false);
+    }
+
+    return *slot;
+}
+
+graph_importer::node_id& graph_importer::integer_slot(std::uint64_t id) {
+    auto const size = std::uint64_t(dense_ids.size());
+
+    if (id < size)
+        return dense_ids[std::size_t(id)];
+
+    // Grow the flat table geometrically, but only over ids that stay
+    // dense, so that a single large id does not allocate a huge table.
+    auto const limit = 2 * (std::uint64_t(defined.size()) + 1);
+
+    if (id >= limit)
+        return sparse_ids.emplace(id, frozen_graph::npos).first->second;
+
+    auto const grown = std::min(std::max(id + 1, 2 * size), limit);
+    dense_ids.resize(std::size_t(grown), frozen_graph::npos);
+
+    // Move ids seen while they were outliers into the table.
+    if (grown - size < sparse_ids.size()) {
+        for (auto i = size; i < grown; ++i) {
+            auto it = sparse_ids.find(i);
+
+            if (it != sparse_ids.end()) {
+                dense_ids[std::size_t(i)] = it->second;
+                sparse_ids.erase(it);
+            }
+        }
+    } else {
+        for (auto it = sparse_ids.begin(); it != sparse_ids.end();) {
+            if (it->first < grown) {
+                dense_ids[std::size_t(it->first)] = it->second;
+                it = sparse_ids.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return dense_ids[std::size_t(id)];
+}
+
+std::invalid_argument graph_importer::error(std::string const& what) const {
+    return std::invalid_argument("Line " + std::to_string(line) + ": " + what);
+}
@@ -23,39 +23,92 @@
  */
 
 #include "graph_node.hpp"
+#include "graph_journal.hpp"
+
+#include <new>
+#include <stdexcept>
 
 using namespace nodal;
 
+struct graph_node::attribute_block {
+    attribute_block(attribute_map const* map, arena* owner)
+        : owner(owner), map(map ? attribute_map(*map, owner)
+                                : attribute_map(owner))
+        {}
+
+    std::atomic<std::size_t> ref_count { 0 };
+    arena* owner;
+    attribute_map map;
+};
+
 graph_node::graph_node(class node const* node)
-    : node_(node), data_(nullptr)
+    : node_(node), data_(nullptr), attributes(nullptr), arena_(nullptr)
 {
     if (node)
-        data_ = node->data();
+        data_ = acquire(node->data());
+}
+
+graph_node::graph_node(class node const* node, arena* arena)
+    : node_(node), data_(nullptr), attributes(nullptr), arena_(arena)
+{
+    arena::scope scope(arena);
+
+    if (node)
+        data_ = acquire(node->data());
 }
 
 graph_node::graph_node(graph_node const& other)
-    : node_(other.node_), data_(nullptr), attributes(other.attributes)
+    : node_(other.node_), data_(nullptr), attributes(nullptr), arena_(nullptr)
+{
+    if (!other.arena_) {
+        data_ = acquire(other.data_);
+        attributes = acquire(other.attributes);
+        return;
+    }
+
+    arena::scope scope(nullptr);
+
+    if (other.data_)
+        data_ = acquire(other.data_->clone());
+
+    if (other.attributes)
+        attributes = acquire(make_attributes(&other.attributes->map, nullptr));
+}
+
+graph_node::graph_node(graph_node const& other, arena* arena)
+    : node_(other.node_), data_(nullptr), attributes(nullptr), arena_(arena)
 {
+    arena::scope scope(arena);
+
     if (other.data_)
-        data_ = other.data_->clone();
+        data_ = acquire(other.data_->clone());
+
+    if (other.attributes)
+        attributes = acquire(make_attributes(&other.attributes->map, arena));
 }
 
 graph_node::graph_node(graph_node&& other)
-    : node_(other.node_), data_(other.data_),
-      attributes(std::move(other.attributes))
+    : node_(other.node_), data_(other.data_), attributes(other.attributes),
+      arena_(other.arena_)
 {
     other.data_ = nullptr;
+    other.attributes = nullptr;
 }
 
 graph_node::~graph_node() {
-    if (data_)
-        delete data_;
+    release(data_);
+    release(attributes);
 }
 
 graph_node& graph_node::operator=(graph_node const& other) {
-    node_ = other.node_;
-    data_ = other.data_->clone();
-    attributes = other.attributes;
+    if (this == &other)
+        return *this;
+
+    graph_node copy = arena_ ? graph_node(other, arena_) : graph_node(other);
+
+    std::swap(node_, copy.node_);
+    std::swap(data_, copy.data_);
+    std::swap(attributes, copy.attributes);
 
     return *this;
 }
@@ -64,6 +117,101 @@ graph_node& graph_node::operator=(graph_node&& other) {
     std::swap(node_, other.node_);
     std::swap(data_, other.data_);
     std::swap(attributes, other.attributes);
+    std::swap(arena_, other.arena_);
 
     return *this;
 }
+
+attribute_value const& graph_node::attribute(attribute_key const& key) const {
+    if (!attributes)
+        throw std::out_of_range("graph_node::attribute");
+
+    return attributes->map.at(key);
+}
+
+bool graph_node::has_attribute(attribute_key const& key) const {
+    return attributes && attributes->map.count(key);
+}
+
+node_data* graph_node::acquire(node_data* data) {
+    if (data)
+        data->ref_count.fetch_add(1, std::memory_order_relaxed);
+
+    return data;
+}
+
+graph_node::attribute_block* graph_node::acquire(attribute_block* attributes) {
+    if (attributes)
+        attributes->ref_count.fetch_add(1, std::memory_order_relaxed);
+
+    return attributes;
+}
+
+void graph_node::release(node_data* data) {
+    if (data && data->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete data;
+}
+
+void graph_node::release(attribute_block* attributes) {
+    if (!attributes ||
+        attributes->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    if (attributes->owner)
+        attributes->~attribute_block();
+    else
+        delete attributes;
+}
+
+graph_node::attribute_block* graph_node::make_attributes(
+    attribute_map const* map, arena* arena) {
+    if (arena) {
+        return new (arena->allocate(sizeof(attribute_block),
+                                    alignof(attribute_block)))
+            attribute_block(map, arena);
+    }
+
+    return new attribute_block(map, nullptr);
+}
+
+void graph_node::set_data(node_data const* data) {
+    node_data* copy = nullptr;
+
+    if (data) {
+        arena::scope scope(arena_);
+        copy = acquire(data->clone());
+    }
+
+    release(data_);
+    data_ = copy;
+
+    if (journal_)
+        record_data_write();
+}
+
+void graph_node::detach_data() {
+    arena::scope scope(arena_);
+
+    auto copy = acquire(data_->clone());
+    release(data_);
+    data_ = copy;
+}
+
+void graph_node::record_data_write() {
+    journal_->record(graph_event::data_changed, handle_);
+}
+
+attribute_map& graph_node::writable_attributes() {
+    if (journal_)
+        journal_->record(graph_event::attribute_changed, handle_);
+
+    if (!attributes) {
+        attributes = acquire(make_attributes(nullptr, arena_));
+    } else if (attributes->ref_count.load(std::memory_order_acquire) > 1) {
+        auto copy = acquire(make_attributes(&attributes->map, arena_));
+        release(attributes);
+        attributes = copy;
+    }
+
+    return attributes->map;
+}
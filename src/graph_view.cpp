@@ -0,0 +1,83 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "graph_view.hpp"
+
+#include <stdexcept>
+
+using namespace nodal;
+
+graph_view::graph_view(graph const& graph, std::vector<graph_node*> nodes,
+                       link_filter links)
+    : graph_(&graph), link_filter_(std::move(links))
+{
+    if (nodes.size() >= npos)
+        throw std::length_error("Too many nodes in view");
+
+    ids_.reserve(nodes.size());
+    nodes_.reserve(nodes.size());
+
+    for (auto node : nodes) {
+        if (!graph.has(node))
+            throw std::out_of_range("Node not in graph");
+
+        insert(node);
+    }
+}
+
+graph_view::graph_view(graph const& graph,
+                       boost::dynamic_bitset<> const& mask,
+                       link_filter links)
+    : graph_(&graph), link_filter_(std::move(links))
+{
+    if (mask.size() > graph.node_count())
+        throw std::out_of_range("Node mask larger than graph");
+
+    ids_.reserve(mask.count());
+    nodes_.reserve(mask.count());
+
+    auto nodes = graph.nodes_begin();
+
+    for (auto i = mask.find_first(); i != mask.npos; i = mask.find_next(i))
+        insert(nodes[i]);
+}
+
+graph_view::graph_view(graph const& graph, node_filter nodes,
+                       link_filter links)
+    : graph_(&graph), link_filter_(std::move(links))
+{
+    for (auto it = graph.nodes_begin(); it != graph.nodes_end(); ++it) {
+        if (nodes(*it))
+            insert(*it);
+    }
+}
+
+std::size_t graph_view::link_count() const {
+    std::size_t count = 0;
+
+    for (auto node : nodes_)
+        count += output_degree(node);
+
+    return count;
+}
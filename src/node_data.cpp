@@ -24,8 +24,43 @@
 
 #include "node_data.hpp"
 
+#include "arena.hpp"
+
+#include <new>
+
 using namespace nodal;
 
+namespace
+{
+
+// Prefix of every node_data allocation, recording where it came from.
+struct alignas(std::max_align_t) allocation_header {
+    arena* owner;
+};
+
+} /* namespace */
+
+void* node_data::operator new(std::size_t size) {
+    auto owner = arena::current();
+    auto block_size = sizeof(allocation_header) + size;
+
+    void* block = owner ? owner->allocate(block_size,
+                                          alignof(allocation_header))
+                        : ::operator new(block_size);
+
+    return new (block) allocation_header{ owner } + 1;
+}
+
+void node_data::operator delete(void* ptr) {
+    if (!ptr)
+        return;
+
+    auto header = static_cast<allocation_header*>(ptr) - 1;
+
+    if (!header->owner)
+        ::operator delete(header);
+}
+
 void* node_data::data_ptr(std::size_t) const {
     throw std::logic_error("node_data::data_ptr");
 }
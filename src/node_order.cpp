@@ -0,0 +1,171 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "node_order.hpp"
+
+#include <algorithm>
+
+using namespace nodal;
+
+std::vector<graph_node*> nodal::topological_order(graph const& graph) {
+    auto nodes = graph.nodes_begin();
+    auto count = graph.node_count();
+
+    std::vector<std::size_t> pending(count);
+    std::vector<graph_node*> order;
+    order.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        pending[i] = graph.input_degree(nodes[i]);
+
+        if (pending[i] == 0)
+            order.push_back(nodes[i]);
+    }
+
+    for (std::size_t next = 0; next < order.size(); ++next) {
+        auto links = graph.output_links(order[next]);
+
+        for (auto link = links.first; link != links.second; ++link) {
+            if (--pending[link->target_node->index()] == 0)
+                order.push_back(link->target_node);
+        }
+    }
+
+    if (order.size() < count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (pending[i] != 0)
+                order.push_back(nodes[i]);
+        }
+    }
+
+    return order;
+}
+
+std::vector<graph_node*> nodal::breadth_first_order(graph const& graph) {
+    auto nodes = graph.nodes_begin();
+    auto count = graph.node_count();
+
+    std::vector<bool> seen(count);
+    std::vector<graph_node*> order;
+    order.reserve(count);
+
+    auto visit = [&](graph_node* node) {
+        if (!seen[node->index()]) {
+            seen[node->index()] = true;
+            order.push_back(node);
+        }
+    };
+
+    auto search = [&](std::size_t next) {
+        for (; next < order.size(); ++next) {
+            auto links = graph.output_links(order[next]);
+
+            for (auto link = links.first; link != links.second; ++link)
+                visit(link->target_node);
+        }
+    };
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (graph.input_degree(nodes[i]) == 0)
+            visit(nodes[i]);
+    }
+
+    search(0);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!seen[i]) {
+            auto next = order.size();
+            visit(nodes[i]);
+            search(next);
+        }
+    }
+
+    return order;
+}
+
+std::vector<graph_node*> nodal::reverse_cuthill_mckee_order(
+    graph const& graph) {
+    auto nodes = graph.nodes_begin();
+    auto count = graph.node_count();
+
+    std::vector<std::size_t> degree(count);
+    std::vector<std::size_t> by_degree(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        degree[i] = graph.degree(nodes[i]);
+        by_degree[i] = i;
+    }
+
+    std::stable_sort(by_degree.begin(), by_degree.end(),
+                     [&](std::size_t a, std::size_t b) {
+                         return degree[a] < degree[b];
+                     });
+
+    std::vector<bool> seen(count);
+    std::vector<graph_node*> order;
+    std::vector<graph_node*> neighbours;
+    order.reserve(count);
+
+    auto visit = [&](graph_node* node) {
+        if (!seen[node->index()]) {
+            seen[node->index()] = true;
+            neighbours.push_back(node);
+        }
+    };
+
+    for (auto start : by_degree) {
+        if (seen[start])
+            continue;
+
+        seen[start] = true;
+        order.push_back(nodes[start]);
+
+        for (auto next = order.size() - 1; next < order.size(); ++next) {
+            auto node = order[next];
+            neighbours.clear();
+
+            auto inputs = graph.input_links(node);
+            for (auto link = inputs.first; link != inputs.second; ++link)
+                visit(link->source_node);
+
+            auto outputs = graph.output_links(node);
+            for (auto link = outputs.first; link != outputs.second; ++link)
+                visit(link->target_node);
+
+            std::sort(neighbours.begin(), neighbours.end(),
+                      [&](graph_node* a, graph_node* b) {
+                          return std::make_pair(degree[a->index()],
+                                                a->index()) <
+                                 std::make_pair(degree[b->index()],
+                                                b->index());
+                      });
+
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+
+    return order;
+}
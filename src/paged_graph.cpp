@@ -0,0 +1,232 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "paged_graph.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <list>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace nodal;
+
+namespace nodal
+{
+
+namespace detail
+{
+
+    // Least recently used cache of fixed-size pages read from a file.
+    class page_cache {
+    public:
+        page_cache(int fd, std::uint64_t file_size, std::size_t page_size,
+                   std::size_t capacity)
+            : fd(fd), file_size(file_size), page_size(page_size),
+              capacity(std::max<std::size_t>(capacity, 1))
+            {}
+
+        ~page_cache() {
+            ::close(fd);
+        }
+
+        page_cache(page_cache const&) = delete;
+        page_cache& operator=(page_cache const&) = delete;
+
+        void read(std::uint64_t offset, void* out, std::size_t size) {
+            auto dest = static_cast<unsigned char*>(out);
+
+            while (size) {
+                auto index = offset / page_size;
+                auto skip = std::size_t(offset % page_size);
+                auto count = std::min(size, page_size - skip);
+
+                std::memcpy(dest, fetch(index) + skip, count);
+
+                dest += count;
+                offset += count;
+                size -= count;
+            }
+        }
+
+        std::size_t resident_size() const {
+            return pages.size() * page_size;
+        }
+
+    private:
+        struct page {
+            std::uint64_t index;
+            std::unique_ptr<unsigned char[]> data;
+        };
+
+        unsigned char const* fetch(std::uint64_t index) {
+            // Consecutive reads mostly hit the same page.
+            if (!pages.empty() && pages.front().index == index)
+                return pages.front().data.get();
+
+            auto it = lookup.find(index);
+
+            if (it != lookup.end()) {
+                pages.splice(pages.begin(), pages, it->second);
+                return pages.front().data.get();
+            }
+
+            if (pages.size() < capacity) {
+                pages.push_front(
+                    { index, std::unique_ptr<unsigned char[]>(
+                                 new unsigned char[page_size]) });
+            } else {
+                lookup.erase(pages.back().index);
+                pages.splice(pages.begin(), pages, std::prev(pages.end()));
+                pages.front().index = index;
+            }
+
+            try {
+                load(index, pages.front().data.get());
+            } catch (...) {
+                pages.pop_front();
+                throw;
+            }
+
+            lookup.emplace(index, pages.begin());
+            return pages.front().data.get();
+        }
+
+        void load(std::uint64_t index, unsigned char* data) {
+            auto offset = index * page_size;
+
+            if (offset >= file_size)
+                throw std::out_of_range("Read past the end of graph image");
+
+            auto size = std::size_t(
+                std::min<std::uint64_t>(page_size, file_size - offset));
+
+            while (size) {
+                auto count = ::pread(fd, data, size, off_t(offset));
+
+                if (count < 0 && errno == EINTR)
+                    continue;
+
+                if (count < 0)
+                    throw std::system_error(errno, std::generic_category(),
+                                            "paged_graph");
+
+                if (count == 0)
+                    throw std::out_of_range("Graph image truncated");
+
+                data += count;
+                offset += std::uint64_t(count);
+                size -= std::size_t(count);
+            }
+        }
+
+        int fd;
+        std::uint64_t file_size;
+        std::size_t page_size;
+        std::size_t capacity;
+
+        std::list<page> pages;
+        std::unordered_map<std::uint64_t, std::list<page>::iterator> lookup;
+    };
+
+} /* namespace detail */
+
+} /* namespace nodal */
+
+paged_graph::paged_graph(std::string const& path, std::size_t cache_size,
+                         std::size_t page_size) {
+    if (!page_size)
+        throw std::invalid_argument("Page size must not be zero");
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), path);
+
+    struct stat st;
+
+    if (::fstat(fd, &st) < 0) {
+        auto error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+
+    cache_.reset(new detail::page_cache(fd, std::uint64_t(st.st_size),
+                                        page_size, cache_size / page_size));
+
+    detail::image_header h;
+
+    if (std::uint64_t(st.st_size) < sizeof(h))
+        throw std::invalid_argument("Not a graph image");
+
+    read(0, &h, sizeof(h));
+
+    if (!h.valid(std::uint64_t(st.st_size)))
+        throw std::invalid_argument("Not a graph image");
+
+    node_count_ = std::size_t(h.node_count);
+    link_count_ = std::size_t(h.link_count);
+
+    types_ = h.types;
+    output_offsets_ = h.output_offsets;
+    links_ = h.links;
+    input_offsets_ = h.input_offsets;
+    input_index_ = h.input_index;
+    data_offsets_ = h.data_offsets;
+    data_sizes_ = h.data_sizes;
+    data_ = h.data;
+}
+
+paged_graph::paged_graph(paged_graph&& other) = default;
+paged_graph& paged_graph::operator=(paged_graph&& other) = default;
+
+paged_graph::~paged_graph() = default;
+
+std::vector<std::uint8_t> paged_graph::data(node_id node) const {
+    auto offset = read<std::uint64_t>(data_offsets_, node);
+    auto size = read<std::uint32_t>(data_sizes_, node) &
+                ~detail::image_serialized_flag;
+
+    std::vector<std::uint8_t> block(size);
+
+    if (size)
+        read(data_ + offset, block.data(), size);
+
+    return block;
+}
+
+std::size_t paged_graph::resident_size() const {
+    return cache_->resident_size();
+}
+
+void paged_graph::read(std::uint64_t offset, void* out,
+                       std::size_t size) const {
+    cache_->read(offset, out, size);
+}
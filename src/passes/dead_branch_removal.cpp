@@ -24,6 +24,8 @@
 
 #include "passes/dead_branch_removal.hpp"
 
+#include "detail/vertex_scratch.hpp"
+
 #include <boost/graph/depth_first_search.hpp>
 
 using namespace nodal;
@@ -31,50 +33,54 @@ using namespace nodal;
 namespace
 {
 
+using count_map = detail::vertex_scratch<std::size_t, graph>::map_type;
+using flag_map = detail::vertex_scratch<char, graph>::map_type;
+
 class dbr_visitor : public boost::default_dfs_visitor {
 public:
-    dbr_visitor(std::function<bool(graph_node const* n)> const& keep)
-        : keep(keep)
+    dbr_visitor(std::function<bool(graph_node const* n)> const& keep,
+                count_map use_count, flag_map dead)
+        : keep(keep), use_count(use_count), dead(dead)
         {}
 
     void initialize_vertex(graph_node* n, graph const& g) const {
-        n->attribute("use_count") = g.output_degree(n);
-        n->attribute("dead") = false;
+        put(use_count, n, g.output_degree(n));
     }
 
     void finish_vertex(graph_node* n, graph const& g) const {
         if (keep && keep(n))
             return;
 
-        if (n->attribute("use_count").cast<std::size_t>() < 1) {
-            n->attribute("dead") = true;
+        if (get(use_count, n) < 1) {
+            put(dead, n, true);
 
             auto links = g.input_links(n);
 
-            for (auto link = links.first; link != links.second; ++link) {
-                auto& c = link->source_node->attribute("use_count");
-                c = c.cast<std::size_t>() - 1;
-            }
+            for (auto link = links.first; link != links.second; ++link)
+                --use_count[link->source_node];
         }
     }
 
 private:
     std::function<bool(graph_node const* n)> const& keep;
+    count_map use_count;
+    flag_map dead;
 };
 
 } /* namespace */
 
 any dead_branch_removal_pass::run(graph& graph, context&) const {
-    boost::depth_first_search(graph, dbr_visitor(keep),
-                              boost::get(boost::vertex_color, graph));
-
-    auto nodes = graph.nodes();
-    for (auto node = nodes.first; node != nodes.second;) {
-        if ((*node)->attribute("dead"))
-            node = graph.remove(node);
-        else
-            ++node;
-    }
+    detail::vertex_scratch<boost::default_color_type, nodal::graph> color(
+        graph);
+    detail::vertex_scratch<std::size_t, nodal::graph> use_count(graph);
+    detail::vertex_scratch<char, nodal::graph> dead(graph);
+
+    boost::depth_first_search(graph,
+                              dbr_visitor(keep, use_count.map(), dead.map()),
+                              color.map());
+
+    auto is_dead = dead.map();
+    graph.remove_if([&](graph_node* n) { return get(is_dead, n) != 0; });
 
     return {};
 }
@@ -0,0 +1,82 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "passes/flatten.hpp"
+
+#include "subgraph_node.hpp"
+
+#include <vector>
+
+using namespace nodal;
+
+any flatten_pass::run(graph& graph, context&) const {
+    std::vector<graph_node*> instances;
+    std::vector<graph_node*> copies;
+
+    // Expanded bodies are added at the end of the node list, so nested
+    // instances are reached by the same loop.
+    for (std::size_t i = 0; i < graph.node_count(); ++i) {
+        auto instance = graph.nodes_begin()[i];
+        auto subgraph = dynamic_cast<subgraph_node const*>(instance->node());
+
+        if (!subgraph)
+            continue;
+
+        auto const& body = *subgraph->body();
+
+        copies.clear();
+        for (auto node = body.nodes_begin(); node != body.nodes_end(); ++node)
+            copies.push_back(graph.add(new graph_node(**node)));
+
+        for (auto link = body.links_begin(); link != body.links_end();
+             ++link) {
+            graph.link(copies[link->source_node->index()], link->source_socket,
+                       copies[link->target_node->index()],
+                       link->target_socket);
+        }
+
+        auto inputs = graph.input_links(instance);
+
+        for (auto link = inputs.first; link != inputs.second; ++link) {
+            auto const& port = subgraph->inputs()[link->target_socket];
+            graph.link(link->source_node, link->source_socket,
+                       copies[port.node], port.socket);
+        }
+
+        auto outputs = graph.output_links(instance);
+
+        for (auto link = outputs.first; link != outputs.second; ++link) {
+            auto const& port = subgraph->outputs()[link->source_socket];
+            graph.link(copies[port.node], port.socket,
+                       link->target_node, link->target_socket);
+        }
+
+        instances.push_back(instance);
+    }
+
+    for (auto instance : instances)
+        graph.remove(instance);
+
+    return {};
+}
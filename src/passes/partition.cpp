@@ -0,0 +1,505 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "passes/partition.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace nodal;
+
+namespace
+{
+
+constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+// Undirected graph in CSR form. Edge weights count the links merged into
+// an edge; vertex weights sum the cost of the nodes merged into a vertex.
+struct level {
+    std::vector<double> weight;
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> adjacent;
+    std::vector<std::size_t> edge_weight;
+
+    // Vertex of the next coarser level holding each vertex.
+    std::vector<std::uint32_t> coarse;
+
+    std::size_t size() const {
+        return weight.size();
+    }
+};
+
+// Accumulates the edges of one vertex, merging parallel ones.
+class edge_merger {
+public:
+    explicit edge_merger(std::size_t size) : slot(size, npos) {}
+
+    void add(level& l, std::uint32_t vertex, std::size_t weight) {
+        if (slot[vertex] == npos) {
+            slot[vertex] = std::uint32_t(l.adjacent.size());
+            l.adjacent.push_back(vertex);
+            l.edge_weight.push_back(weight);
+        } else {
+            l.edge_weight[slot[vertex]] += weight;
+        }
+    }
+
+    void finish(level& l) {
+        for (auto i = l.offsets.back(); i < l.adjacent.size(); ++i)
+            slot[l.adjacent[i]] = npos;
+
+        l.offsets.push_back(std::uint32_t(l.adjacent.size()));
+    }
+
+private:
+    std::vector<std::uint32_t> slot;
+};
+
+level base_level(graph const& graph, std::vector<double> weight) {
+    auto nodes = graph.nodes_begin();
+    auto count = graph.node_count();
+
+    level l;
+    l.weight = std::move(weight);
+    l.offsets.reserve(count + 1);
+    l.offsets.push_back(0);
+    l.adjacent.reserve(2 * graph.link_count());
+    l.edge_weight.reserve(2 * graph.link_count());
+
+    edge_merger edges(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        auto inputs = graph.input_links(nodes[i]);
+        for (auto link = inputs.first; link != inputs.second; ++link) {
+            if (link->source_node->index() != i)
+                edges.add(l, std::uint32_t(link->source_node->index()), 1);
+        }
+
+        auto outputs = graph.output_links(nodes[i]);
+        for (auto link = outputs.first; link != outputs.second; ++link) {
+            if (link->target_node->index() != i)
+                edges.add(l, std::uint32_t(link->target_node->index()), 1);
+        }
+
+        edges.finish(l);
+    }
+
+    return l;
+}
+
+// Match each vertex with the unmatched neighbour it shares the heaviest
+// edge with, visiting vertices in random order, and merge the pairs.
+// Returns an empty level if matching no longer shrinks the graph.
+level coarsen(level& fine, double max_weight, std::mt19937& random) {
+    auto size = fine.size();
+
+    std::vector<std::uint32_t> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), random);
+
+    std::vector<std::uint32_t> match(size, npos);
+
+    for (auto v : order) {
+        if (match[v] != npos)
+            continue;
+
+        auto best = v;
+        std::size_t best_weight = 0;
+
+        for (auto e = fine.offsets[v]; e < fine.offsets[v + 1]; ++e) {
+            auto u = fine.adjacent[e];
+
+            if (match[u] == npos && fine.edge_weight[e] > best_weight &&
+                fine.weight[v] + fine.weight[u] <= max_weight) {
+                best = u;
+                best_weight = fine.edge_weight[e];
+            }
+        }
+
+        match[v] = best;
+        match[best] = v;
+    }
+
+    fine.coarse.assign(size, npos);
+
+    std::vector<std::uint32_t> members;
+    members.reserve(size);
+
+    for (std::uint32_t v = 0; v < size; ++v) {
+        if (fine.coarse[v] == npos) {
+            fine.coarse[v] = fine.coarse[match[v]] =
+                std::uint32_t(members.size());
+            members.push_back(v);
+        }
+    }
+
+    // Stop once matching leaves nearly every vertex on its own.
+    if (members.size() > size - size / 20) {
+        fine.coarse.clear();
+        return {};
+    }
+
+    level l;
+    l.weight.reserve(members.size());
+    l.offsets.reserve(members.size() + 1);
+    l.offsets.push_back(0);
+
+    edge_merger edges(members.size());
+
+    for (std::uint32_t c = 0; c < members.size(); ++c) {
+        std::uint32_t pair[] = { members[c], match[members[c]] };
+        auto count = pair[0] == pair[1] ? 1 : 2;
+
+        double weight = 0;
+
+        for (int i = 0; i < count; ++i) {
+            auto v = pair[i];
+            weight += fine.weight[v];
+
+            for (auto e = fine.offsets[v]; e < fine.offsets[v + 1]; ++e) {
+                auto u = fine.coarse[fine.adjacent[e]];
+
+                if (u != c)
+                    edges.add(l, u, fine.edge_weight[e]);
+            }
+        }
+
+        l.weight.push_back(weight);
+        edges.finish(l);
+    }
+
+    return l;
+}
+
+// Grow each part breadth-first from a random seed until it holds its
+// share of the weight left; the last part takes the remaining vertices.
+std::vector<std::uint32_t> grow_partition(level const& l, std::uint32_t parts,
+                                          std::mt19937& random) {
+    auto size = l.size();
+    std::vector<std::uint32_t> part(size, npos);
+
+    std::vector<std::uint32_t> seeds(size);
+    std::iota(seeds.begin(), seeds.end(), 0);
+    std::shuffle(seeds.begin(), seeds.end(), random);
+
+    double remaining =
+        std::accumulate(l.weight.begin(), l.weight.end(), 0.0);
+
+    std::vector<std::uint32_t> queue;
+    std::size_t seed = 0;
+
+    for (std::uint32_t p = 0; p + 1 < parts; ++p) {
+        double target = remaining / (parts - p);
+        double grown = 0;
+
+        queue.clear();
+        std::size_t next = 0;
+
+        while (grown < target) {
+            if (next == queue.size()) {
+                while (seed < size && part[seeds[seed]] != npos)
+                    ++seed;
+
+                if (seed == size)
+                    break;
+
+                queue.push_back(seeds[seed]);
+            }
+
+            auto v = queue[next++];
+            if (part[v] != npos)
+                continue;
+
+            part[v] = p;
+            grown += l.weight[v];
+
+            for (auto e = l.offsets[v]; e < l.offsets[v + 1]; ++e) {
+                if (part[l.adjacent[e]] == npos)
+                    queue.push_back(l.adjacent[e]);
+            }
+        }
+
+        remaining -= grown;
+    }
+
+    for (auto& p : part) {
+        if (p == npos)
+            p = parts - 1;
+    }
+
+    return part;
+}
+
+// Move boundary vertices to the neighbouring part they have the most
+// edges to, as long as that part stays within max_weight. Moves that cut
+// no more edges are also taken when they improve balance, and vertices of
+// overweight parts are moved even if that cuts more edges.
+void refine(level const& l, std::vector<std::uint32_t>& part,
+            std::vector<double>& part_weight, double max_weight) {
+    auto parts = std::uint32_t(part_weight.size());
+
+    std::vector<std::size_t> connection(parts);
+    std::vector<std::uint32_t> touched;
+
+    for (int pass = 0; pass < 8; ++pass) {
+        std::size_t moved = 0;
+
+        for (std::uint32_t v = 0; v < l.size(); ++v) {
+            auto from = part[v];
+            auto weight = l.weight[v];
+            bool over = part_weight[from] > max_weight;
+
+            touched.clear();
+
+            for (auto e = l.offsets[v]; e < l.offsets[v + 1]; ++e) {
+                auto p = part[l.adjacent[e]];
+
+                if (connection[p] == 0)
+                    touched.push_back(p);
+
+                connection[p] += l.edge_weight[e];
+            }
+
+            auto to = from;
+            std::int64_t best = 0;
+
+            for (auto p : touched) {
+                if (p == from || part_weight[p] + weight > max_weight)
+                    continue;
+
+                auto gain = std::int64_t(connection[p]) -
+                            std::int64_t(connection[from]);
+
+                bool better =
+                    to == from
+                        ? gain > 0 || over ||
+                              (gain == 0 && part_weight[p] + weight <
+                                                part_weight[from])
+                        : gain > best ||
+                              (gain == best &&
+                               part_weight[p] < part_weight[to]);
+
+                if (better) {
+                    to = p;
+                    best = gain;
+                }
+            }
+
+            if (to == from && over) {
+                auto lightest = std::uint32_t(
+                    std::min_element(part_weight.begin(),
+                                     part_weight.end()) -
+                    part_weight.begin());
+
+                if (part_weight[lightest] + weight <= max_weight)
+                    to = lightest;
+            }
+
+            for (auto p : touched)
+                connection[p] = 0;
+
+            if (to != from) {
+                part_weight[from] -= weight;
+                part_weight[to] += weight;
+                part[v] = to;
+                ++moved;
+            }
+        }
+
+        if (moved == 0)
+            break;
+    }
+}
+
+std::vector<double> part_weights(level const& l,
+                                 std::vector<std::uint32_t> const& part,
+                                 std::uint32_t parts) {
+    std::vector<double> weight(parts);
+
+    for (std::size_t v = 0; v < l.size(); ++v)
+        weight[part[v]] += l.weight[v];
+
+    return weight;
+}
+
+std::size_t cut_weight(level const& l, std::vector<std::uint32_t> const& part) {
+    std::size_t cut = 0;
+
+    for (std::size_t v = 0; v < l.size(); ++v) {
+        for (auto e = l.offsets[v]; e < l.offsets[v + 1]; ++e) {
+            if (part[l.adjacent[e]] != part[v])
+                cut += l.edge_weight[e];
+        }
+    }
+
+    return cut / 2;
+}
+
+// Largest part weight the refinement aims for on a level. Coarse vertices
+// can be heavier than the slack tolerance allows; never demand a balance
+// no move can reach.
+double max_part_weight(level const& l, double average, double tolerance) {
+    double heaviest = *std::max_element(l.weight.begin(), l.weight.end());
+    return std::max(tolerance * average, average + heaviest);
+}
+
+// Grow and refine several partitions of the coarsest level, keeping the
+// best balanced one with the fewest cut edges.
+std::vector<std::uint32_t> initial_partition(level const& l,
+                                             std::uint32_t parts,
+                                             double max_weight,
+                                             std::mt19937& random) {
+    std::vector<std::uint32_t> best;
+    std::size_t best_cut = 0;
+    double best_excess = 0;
+
+    for (int trial = 0; trial < 8; ++trial) {
+        auto part = grow_partition(l, parts, random);
+        auto weight = part_weights(l, part, parts);
+
+        refine(l, part, weight, max_weight);
+
+        auto cut = cut_weight(l, part);
+        auto excess = std::max(
+            *std::max_element(weight.begin(), weight.end()) - max_weight,
+            0.0);
+
+        if (best.empty() || excess < best_excess ||
+            (excess == best_excess && cut < best_cut)) {
+            best = std::move(part);
+            best_cut = cut;
+            best_excess = excess;
+        }
+    }
+
+    return best;
+}
+
+} /* namespace */
+
+partition_pass::partition_pass(std::uint32_t parts, cost_function const& cost,
+                               attribute_key const& column, double tolerance)
+    : parts(parts), cost(cost), column(column), tolerance(tolerance) {
+    if (parts == 0)
+        throw std::invalid_argument("Partition needs at least one part");
+
+    if (!(tolerance >= 1))
+        throw std::invalid_argument("Partition tolerance below 1");
+}
+
+any partition_pass::run(graph& graph, context&) const {
+    auto nodes = graph.nodes_begin();
+    auto count = graph.node_count();
+
+    if (count >= npos)
+        throw std::length_error("Too many nodes to partition");
+
+    std::vector<double> weight(count, 1.0);
+
+    if (cost) {
+        for (std::size_t i = 0; i < count; ++i) {
+            weight[i] = cost(nodes[i]);
+
+            if (!(weight[i] >= 0))
+                throw std::invalid_argument("Negative node cost");
+        }
+    }
+
+    double total = std::accumulate(weight.begin(), weight.end(), 0.0);
+    double average = total / parts;
+    double max_cost =
+        count ? *std::max_element(weight.begin(), weight.end()) : 0.0;
+
+    std::vector<std::uint32_t> part(count, 0);
+
+    if (parts > 1 && count > 0) {
+        std::vector<level> levels;
+        levels.push_back(base_level(graph, std::move(weight)));
+
+        // Fixed seed, so that runs are reproducible.
+        std::mt19937 random(5489u);
+
+        std::size_t coarsest = std::max<std::size_t>(20 * parts, 200);
+        double max_vertex_weight = std::max(1.5 * total / coarsest, max_cost);
+
+        while (levels.back().size() > coarsest) {
+            auto next = coarsen(levels.back(), max_vertex_weight, random);
+            if (next.size() == 0)
+                break;
+
+            levels.push_back(std::move(next));
+        }
+
+        part = initial_partition(
+            levels.back(), parts,
+            max_part_weight(levels.back(), average, tolerance), random);
+
+        for (auto l = levels.size() - 1; l-- > 0;) {
+            auto& current = levels[l];
+            std::vector<std::uint32_t> fine(current.size());
+
+            for (std::size_t v = 0; v < current.size(); ++v)
+                fine[v] = part[current.coarse[v]];
+
+            part = std::move(fine);
+            current.coarse.clear();
+            levels[l + 1] = level();
+
+            auto part_weight = part_weights(current, part, parts);
+            refine(current, part, part_weight,
+                   max_part_weight(current, average, tolerance));
+        }
+
+        weight = std::move(levels.front().weight);
+    }
+
+    auto& parts_column = graph.column<std::uint32_t>(column);
+
+    partition_stats stats;
+    stats.part_costs.assign(parts, 0.0);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        parts_column[nodes[i]] = part[i];
+        stats.part_costs[part[i]] += weight[i];
+    }
+
+    for (auto link = graph.links_begin(); link != graph.links_end(); ++link) {
+        if (part[link->source_node->index()] !=
+            part[link->target_node->index()])
+            ++stats.cut_links;
+    }
+
+    if (total > 0) {
+        stats.imbalance = *std::max_element(stats.part_costs.begin(),
+                                            stats.part_costs.end()) /
+                          average;
+    }
+
+    return stats;
+}
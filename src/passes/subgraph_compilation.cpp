@@ -0,0 +1,115 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "passes/subgraph_compilation.hpp"
+
+#include "subgraph_node.hpp"
+
+#include <unordered_set>
+#include <vector>
+
+using namespace nodal;
+
+namespace
+{
+
+using result_type = subgraph_compilation_pass::result_type;
+
+subgraph_node const* subgraph_of(graph_node const* node) {
+    return dynamic_cast<subgraph_node const*>(node->node());
+}
+
+// Bodies of the subgraphs instantiated directly in graph, each listed once.
+std::vector<graph const*> bodies_in(graph const& graph) {
+    std::vector<nodal::graph const*> bodies;
+    std::unordered_set<nodal::graph const*> seen;
+
+    for (auto node = graph.nodes_begin(); node != graph.nodes_end(); ++node) {
+        if (auto subgraph = subgraph_of(*node)) {
+            if (seen.insert(subgraph->body().get()).second)
+                bodies.push_back(subgraph->body().get());
+        }
+    }
+
+    return bodies;
+}
+
+} /* namespace */
+
+any subgraph_compilation_pass::run(graph& graph, context& ctx) const {
+    result_type results;
+
+    auto previous = ctx.get(typeid(*this));
+    if (!previous.empty())
+        results = previous.cast<result_type>();
+
+    // Depth-first over bodies; a body is compiled once all the bodies
+    // nested in it are.
+    struct frame {
+        nodal::graph const* body;
+        std::vector<nodal::graph const*> nested;
+        std::size_t next;
+    };
+
+    std::vector<frame> stack;
+    auto top = bodies_in(graph);
+
+    for (auto body : top) {
+        if (results.count(body))
+            continue;
+
+        stack.push_back({ body, bodies_in(*body), 0 });
+
+        while (!stack.empty()) {
+            auto& f = stack.back();
+
+            if (f.next < f.nested.size()) {
+                auto nested = f.nested[f.next++];
+
+                if (!results.count(nested))
+                    stack.push_back({ nested, bodies_in(*nested), 0 });
+
+                continue;
+            }
+
+            if (!results.count(f.body)) {
+                context body_ctx;
+                result_type nested_results;
+
+                for (auto nested : f.nested)
+                    nested_results.emplace(nested, results.at(nested));
+
+                if (!nested_results.empty())
+                    body_ctx.set(typeid(*this), std::move(nested_results));
+
+                nodal::graph copy(*f.body);
+                results.emplace(f.body, body_pass.run(copy, body_ctx));
+            }
+
+            stack.pop_back();
+        }
+    }
+
+    return results;
+}
@@ -0,0 +1,59 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "subgraph_node.hpp"
+
+#include <stdexcept>
+
+using namespace nodal;
+
+subgraph_node::subgraph_node(graph body, std::vector<port> inputs,
+                             std::vector<port> outputs)
+    : subgraph_node(std::make_shared<graph const>(std::move(body)),
+                    std::move(inputs), std::move(outputs))
+    {}
+
+subgraph_node::subgraph_node(std::shared_ptr<graph const> body,
+                             std::vector<port> inputs,
+                             std::vector<port> outputs)
+    : body_(std::move(body)), inputs_(std::move(inputs)),
+      outputs_(std::move(outputs))
+{
+    if (!body_)
+        throw std::invalid_argument("Subgraph without a body");
+
+    auto nodes = body_->nodes_begin();
+
+    for (auto const& port : inputs_) {
+        if (port.node >= body_->node_count() ||
+            port.socket >= nodes[port.node]->node()->input_count())
+            throw std::out_of_range("Subgraph input port out of range");
+    }
+
+    for (auto const& port : outputs_) {
+        if (port.node >= body_->node_count() ||
+            port.socket >= nodes[port.node]->node()->output_count())
+            throw std::out_of_range("Subgraph output port out of range");
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 Fabio Massaioli
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "versioned_graph.hpp"
+
+#include <thread>
+
+using namespace nodal;
+
+versioned_graph::versioned_graph()
+    : current(new version(std::make_shared<graph>()))
+{
+    readers[0] = 0;
+    readers[1] = 0;
+}
+
+versioned_graph::versioned_graph(graph initial)
+    : current(new version(std::make_shared<graph>(std::move(initial))))
+{
+    readers[0] = 0;
+    readers[1] = 0;
+}
+
+versioned_graph::~versioned_graph() {
+    delete current.load();
+}
+
+versioned_graph::version versioned_graph::snapshot() const {
+    for (;;) {
+        auto e = epoch.load();
+        auto& count = readers[e & 1];
+
+        count.fetch_add(1);
+
+        // A writer may have moved on, and stopped waiting for this
+        // epoch's readers, before the increment.
+        if (epoch.load() == e) {
+            version result = *current.load();
+            count.fetch_sub(1);
+            return result;
+        }
+
+        count.fetch_sub(1);
+    }
+}
+
+versioned_graph::version versioned_graph::assign(graph next) {
+    std::lock_guard<std::mutex> lock(writer);
+    return publish(std::make_shared<graph>(std::move(next)));
+}
+
+versioned_graph::version
+versioned_graph::publish(std::shared_ptr<graph> next) {
+    version published = std::move(next);
+
+    auto replaced = current.exchange(new version(published));
+    auto& count = readers[epoch.fetch_add(1) & 1];
+
+    while (count.load() != 0)
+        std::this_thread::yield();
+
+    delete replaced;
+    revision_.fetch_add(1, std::memory_order_acq_rel);
+
+    return published;
+}